@@ -0,0 +1,66 @@
+#include "AssetBundle.h"
+#include <cstring>
+
+const char *const AssetBundle::DefaultPath = "assets/bundle.gen.pak";
+
+namespace
+{
+    const size_t HeaderSize = 16;
+    const size_t PathLength = 56;
+    const size_t EntrySize = PathLength + 8;
+}
+
+AssetBundle::AssetBundle(const char *path)
+    : myFile(path), myCount(0)
+{
+    if(myFile.Empty())
+        return;
+    const unsigned char *bytes = myFile.Data();
+    size_t size = myFile.Size();
+    if(size < HeaderSize || memcmp(bytes, "ABND", 4) != 0 ||
+            MappedFile::ReadU32(bytes + 4) != 1 ||
+            MappedFile::ReadU32(bytes + 8) > (size - HeaderSize) / EntrySize)
+    {
+        Debug("Not an asset bundle: %s", path);
+        myFile.Close();
+        return;
+    }
+    myCount = MappedFile::ReadU32(bytes + 8);
+    Debug("Asset bundle %s: %u files", path, myCount);
+}
+
+const AssetBundle &AssetBundle::Default()
+{
+    static AssetBundle bundle(DefaultPath);
+    return bundle;
+}
+
+bool AssetBundle::Find(const char *path, const char *&data, size_t &size) const
+{
+    if(myCount == 0 || strlen(path) >= PathLength)
+        return false;
+    const unsigned char *entries = myFile.Data() + HeaderSize;
+    uint first = 0;
+    uint last = myCount;
+    while(first < last)
+    {
+        uint middle = (first + last) / 2;
+        const unsigned char *entry = entries + middle * EntrySize;
+        int order = strncmp(reinterpret_cast<const char*>(entry), path, PathLength);
+        if(order < 0)
+            first = middle + 1;
+        else if(order > 0)
+            last = middle;
+        else
+        {
+            uint32_t offset = MappedFile::ReadU32(entry + PathLength);
+            uint32_t length = MappedFile::ReadU32(entry + PathLength + 4);
+            if(offset > myFile.Size() || length > myFile.Size() - offset)
+                return false;
+            data = reinterpret_cast<const char*>(myFile.Data()) + offset;
+            size = length;
+            return true;
+        }
+    }
+    return false;
+}
@@ -0,0 +1,73 @@
+#ifndef ASSETBUNDLE_H_
+#define ASSETBUNDLE_H_
+
+#include <string>
+#include <cstddef>
+#include "assets/AssetManager.h"
+#include "MappedFile.h"
+
+using namespace anengine;
+
+/** Read only mapping of the asset bundle the assets build packs
+ * (see assets/generators/bundlegen.c): the shaders, keymap and vertex
+ * buffers in one file with a sorted table of contents. Starting from the
+ * bundle costs one open and sequential reads instead of a seek per file.
+ * Paths are the ones the viewer opens, like "assets/shaders/Sky.sp".
+ */
+class AssetBundle
+{
+    MappedFile myFile;
+    uint myCount;
+
+    AssetBundle(const AssetBundle &);
+    AssetBundle &operator=(const AssetBundle &);
+
+    public:
+    static const char *const DefaultPath;
+
+    /** Maps \a path. A missing or malformed bundle is empty, so every
+     * lookup falls back to the file.
+     */
+    AssetBundle(const char *path);
+    ~AssetBundle() { }
+
+    /** The bundle at DefaultPath, mapped on first use.
+     */
+    static const AssetBundle &Default();
+
+    /** Finds the file \a path, its bytes stay valid as long as the bundle.
+     */
+    bool Find(const char *path, const char *&data, size_t &size) const;
+
+    uint Count() const
+    {
+        return myCount;
+    }
+
+    /** Text asset \a path from the default bundle, or from its file if the
+     * bundle doesn't have it.
+     */
+    template<typename T>
+    static StaticAsset<T> Static(const char *path)
+    {
+        const char *data;
+        size_t size;
+        if(Default().Find(path, data, size))
+            return AssetManager::CreateStaticFromMemory<T>(std::string(data, size));
+        return AssetManager::CreateStaticFromFile<T>(path);
+    }
+
+    /** Like Static, creating the asset in \a manager now.
+     */
+    template<typename T>
+    static AssetRef<T> Load(AssetManager *manager, const char *path)
+    {
+        const char *data;
+        size_t size;
+        if(Default().Find(path, data, size))
+            return manager->CreateFromMemory<T>(std::string(data, size));
+        return manager->CreateFromFile<T>(path);
+    }
+};
+
+#endif
@@ -0,0 +1,132 @@
+#include "BakedHexmap.h"
+#include "AssetBundle.h"
+#include "entity/SceneGraph.h"
+#include "Frustum.h"
+#include <vector>
+
+// The engine binds this for us, OnDraw points the attributes at the mesh.
+StaticAsset<VertexBuffer> BakedHexmap::myVertexBuffer(AssetManager::CreateStaticFromMemory<VertexBuffer>(
+"A2 Position float4 false 24 0 Texcoord float2 false 24 16 1 6"
+"0.0 0.0 0.0 1.0 0.0 0.0 "));
+
+StaticAsset<Program> BakedHexmap::myProgram(AssetBundle
+            ::Static<Program>("assets/shaders/GroundBaked.sp"));
+
+void BakedHexmap::OnCreate()
+{
+    myTexture = myTextureRef;
+    myPalette = Scene.Get()->GetAssetManager()->CreateFromMemory<Texture>("");
+    std::vector<unsigned char> pixels(myColorCount * 4);
+    for(uint i = 0; i < myColorCount; i++)
+    {
+        pixels[i*4+0] = myColors[i][B] * 255;
+        pixels[i*4+1] = myColors[i][G] * 255;
+        pixels[i*4+2] = myColors[i][R] * 255;
+        pixels[i*4+3] = myColors[i][A] * 255;
+    }
+    TextureSettings settings;
+    settings.MinFilter = GL_NEAREST;
+    settings.MagFilter = GL_NEAREST;
+    settings.GenerateMipmap = false;
+    myPalette->SetData(myColorCount, 1, GL_BGRA, &pixels[0], settings);
+    if(!HasProgram())
+    {
+        // Every chunk has its own level of detail, so its own state.
+        AssetRef<Program> program = myProgram.Get(Scene.Get()->GetAssetManager());
+        SetProgram(program, program->CreateState());
+    }
+    FixedGeometry::OnCreate();
+}
+
+void BakedHexmap::OnDestroy()
+{
+    if(myBuffer != 0)
+        glDeleteBuffers(1, &myBuffer);
+    myBuffer = 0;
+    myMesh->MarkFullUpload();
+    myProgramId = 0;
+    myTexture.Release();
+    myPalette.Release();
+    FixedGeometry::OnDestroy();
+}
+
+void BakedHexmap::OnNewProgram()
+{
+    ProgramState().SetUniform("Texture", myTexture);
+    ProgramState().SetUniform("Palette", myPalette);
+    ProgramState().SetUniform("BorderMerge", myBorderMerge ? 1.0f : 0.0f);
+    FixedGeometry::OnNewProgram();
+}
+
+void BakedHexmap::SetBorderMerge(bool merge)
+{
+    if(merge == myBorderMerge)
+        return;
+    myBorderMerge = merge;
+    if(HasProgram())
+        ProgramState().SetUniform("BorderMerge", myBorderMerge ? 1.0f : 0.0f);
+}
+
+bool BakedHexmap::InFrustum(GLint program)
+{
+    if(myViewProjectionUniform == -1 || myWorldUniform == -1)
+        return true;
+    GLfloat viewProjection[16], world[16], transform[16];
+    glGetUniformfv(program, myViewProjectionUniform, viewProjection);
+    glGetUniformfv(program, myWorldUniform, world);
+    Frustum::Multiply(viewProjection, world, transform);
+    return Frustum(transform).Intersects(myMesh->Min(), myMesh->Max());
+}
+
+void BakedHexmap::OnDraw(FrameTime elapsed)
+{
+    if(myMesh->VertexCount() == 0)
+        return;
+    GLint program = 0;
+    glGetIntegerv(GL_CURRENT_PROGRAM, &program);
+    if(program != myProgramId)
+    {
+        myProgramId = program;
+        myPositionAttrib = glGetAttribLocation(program, "Position");
+        myTexcoordAttrib = glGetAttribLocation(program, "Texcoord");
+        myTypeAttrib = glGetAttribLocation(program, "Type");
+        myViewProjectionUniform = glGetUniformLocation(program, "ViewProjection");
+        myWorldUniform = glGetUniformLocation(program, "World");
+    }
+    if(!InFrustum(program))
+        return;
+
+    GLint arrayBuffer = 0;
+    glGetIntegerv(GL_ARRAY_BUFFER_BINDING, &arrayBuffer);
+    if(myBuffer == 0)
+        glGenBuffers(1, &myBuffer);
+    glBindBuffer(GL_ARRAY_BUFFER, myBuffer);
+
+    bool full;
+    size_t offset, size;
+    const void *data;
+    if(myMesh->TakeUpload(full, offset, size, data))
+    {
+        if(full)
+            RenderStats::BufferData(GL_ARRAY_BUFFER, size, data, GL_STATIC_DRAW);
+        else
+            RenderStats::BufferSubData(GL_ARRAY_BUFFER, offset, size, data);
+    }
+
+    if(myPositionAttrib != -1)
+        glVertexAttribPointer(myPositionAttrib, 4, GL_FLOAT, GL_FALSE,
+                HexmapMesh::VertexStride, (const GLvoid*)0);
+    if(myTexcoordAttrib != -1)
+        glVertexAttribPointer(myTexcoordAttrib, 2, GL_FLOAT, GL_FALSE,
+                HexmapMesh::VertexStride, (const GLvoid*)(4*sizeof(float)));
+    if(myTypeAttrib != -1)
+    {
+        glEnableVertexAttribArray(myTypeAttrib);
+        glVertexAttribPointer(myTypeAttrib, 1, GL_FLOAT, GL_FALSE, 0,
+                (const GLvoid*)myMesh->TypeOffset());
+    }
+    RenderStats::DrawArrays(GL_TRIANGLES, 0, myMesh->VertexCount());
+    if(myTypeAttrib != -1)
+        glDisableVertexAttribArray(myTypeAttrib);
+    glBindBuffer(GL_ARRAY_BUFFER, arrayBuffer);
+}
@@ -0,0 +1,65 @@
+#ifndef BAKEDHEXMAP_H_
+#define BAKEDHEXMAP_H_
+
+#include "entity/FixedGeometry.h"
+#include "assets/AssetManager.h"
+#include "HexmapMesh.h"
+#include "RenderStats.h"
+
+using namespace anengine;
+
+/** Draws a HexmapMesh, ground and borders, in one draw call.
+ * The mesh lives in a buffer of its own that is bound with raw GL in
+ * OnDraw; patches collected by the mesh are uploaded at most once a frame
+ * right before drawing. Meshes whose bounds are outside the view frustum
+ * are neither uploaded nor drawn.
+ */
+class BakedHexmap : public FixedGeometry
+{
+    static StaticAsset<VertexBuffer> myVertexBuffer;
+    static StaticAsset<Program> myProgram;
+
+    HexmapMesh *myMesh;
+    AssetRef<Texture> myTextureRef;
+    Asset<Texture> myTexture;
+    Asset<Texture> myPalette;
+    const ColorF *myColors;
+    uint myColorCount;
+    GLuint myBuffer;
+    GLint myProgramId;
+    GLint myPositionAttrib;
+    GLint myTexcoordAttrib;
+    GLint myTypeAttrib;
+    GLint myViewProjectionUniform;
+    GLint myWorldUniform;
+    bool myBorderMerge;
+
+    bool InFrustum(GLint program);
+
+    protected:
+    virtual AssetRef<VertexBuffer> GetGeometry(AssetManager *manager)
+    {
+        return myVertexBuffer.Get(manager);
+    }
+    virtual void OnDraw(FrameTime elapsed);
+    virtual void OnNewProgram();
+    virtual void OnCreate();
+    virtual void OnDestroy();
+
+    public:
+    /** \a colors are the border colours, indexed by tile type.
+     */
+    BakedHexmap(HexmapMesh *mesh, AssetRef<Texture> texture,
+            const ColorF *colors, uint colorCount)
+        : myMesh(mesh), myTextureRef(texture), myColors(colors),
+        myColorCount(colorCount), myBuffer(0), myProgramId(0),
+        myPositionAttrib(-1), myTexcoordAttrib(-1), myTypeAttrib(-1),
+        myViewProjectionUniform(-1), myWorldUniform(-1), myBorderMerge(false) { }
+    virtual ~BakedHexmap() { }
+
+    /** Paint the borders in the tile pass instead of drawing them.
+     */
+    void SetBorderMerge(bool merge);
+};
+
+#endif
@@ -0,0 +1,82 @@
+#ifndef COMMANDQUEUE_H_
+#define COMMANDQUEUE_H_
+
+#include <atomic>
+#include "core/Debug.h"
+
+using namespace anengine;
+
+/** Fixed size ring of commands from one producer thread to one consumer
+ * thread. Neither side takes a lock: the producer only writes the tail,
+ * the consumer only the head, and each publishes its slot with a release
+ * store the other side reads with acquire. \a Size must be a power of two.
+ */
+template<typename T, uint Size>
+class CommandQueue
+{
+    static_assert((Size & (Size - 1)) == 0, "Size must be a power of two");
+
+    T mySlots[Size];
+    std::atomic<uint> myHead;
+    std::atomic<uint> myTail;
+    uint myMaxDepth;
+    uint myOverflows;
+
+    public:
+    CommandQueue()
+        : myHead(0), myTail(0), myMaxDepth(0), myOverflows(0) { }
+
+    /** Producer side. Returns false, and counts an overflow, when full.
+     */
+    bool Push(const T &command)
+    {
+        uint tail = myTail.load(std::memory_order_relaxed);
+        uint depth = tail - myHead.load(std::memory_order_acquire);
+        if(depth == Size)
+        {
+            myOverflows++;
+            return false;
+        }
+        mySlots[tail % Size] = command;
+        myTail.store(tail + 1, std::memory_order_release);
+        if(depth + 1 > myMaxDepth)
+            myMaxDepth = depth + 1;
+        return true;
+    }
+
+    /** Consumer side. Returns false when empty.
+     */
+    bool Pop(T &command)
+    {
+        uint head = myHead.load(std::memory_order_relaxed);
+        if(head == myTail.load(std::memory_order_acquire))
+            return false;
+        command = mySlots[head % Size];
+        myHead.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+    /** Commands waiting, exact on either side, a snapshot elsewhere.
+     */
+    uint Depth() const
+    {
+        return myTail.load(std::memory_order_acquire) -
+            myHead.load(std::memory_order_acquire);
+    }
+
+    /** Deepest the queue has been after a push. Producer side.
+     */
+    uint MaxDepth() const
+    {
+        return myMaxDepth;
+    }
+
+    /** Pushes refused because the queue was full. Producer side.
+     */
+    uint Overflows() const
+    {
+        return myOverflows;
+    }
+};
+
+#endif
@@ -0,0 +1,30 @@
+#ifndef CULLEDBILLBOARD_H_
+#define CULLEDBILLBOARD_H_
+
+#include "entity/Billboard.h"
+
+using namespace anengine;
+
+/** Billboard that skips its draw while Culled is set.
+ * Kept apart from Visible, which the game logic owns, so the visibility
+ * pass never overrides whether a billboard should be shown.
+ */
+class CulledBillboard : public Billboard
+{
+    protected:
+    virtual void OnDraw(FrameTime elapsed)
+    {
+        if(!Culled)
+            Billboard::OnDraw(elapsed);
+    }
+    public:
+    bool Culled;
+
+    CulledBillboard()
+        : Billboard(), Culled(false) { }
+    CulledBillboard(AssetRef<Texture> texture)
+        : Billboard(texture), Culled(false) { }
+    virtual ~CulledBillboard() { }
+};
+
+#endif
@@ -51,7 +51,7 @@ void Fader::OnNewProgram()
 void Fader::OnDraw(FrameTime elapsed)
 {
     //glPolygonMode( GL_FRONT_AND_BACK, GL_LINE );
-    glDrawArrays(GL_TRIANGLES, 0, 6);
+    RenderStats::DrawArrays(GL_TRIANGLES, 0, 6);
 }
 
 void FaderAnimationData::Update(real t)
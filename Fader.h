@@ -3,6 +3,7 @@
 
 #include "entity/Sprite.h"
 #include "util/AnimationHelper.h"
+#include "RenderStats.h"
 using namespace anengine;
 
 class Fader : public Sprite
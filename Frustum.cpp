@@ -0,0 +1,42 @@
+#include "Frustum.h"
+
+Frustum::Frustum(const float *m)
+{
+    // Row i of the matrix is m[i], m[4+i], m[8+i], m[12+i]. The planes are
+    // row 3 plus and minus each of rows 0 to 2.
+    for(int p = 0; p < 6; p++)
+    {
+        int row = p / 2;
+        float sign = p % 2 == 0 ? 1.0f : -1.0f;
+        for(int c = 0; c < 4; c++)
+            myPlanes[p][c] = m[c*4+3] + sign * m[c*4+row];
+    }
+}
+
+bool Frustum::Intersects(const float *min, const float *max) const
+{
+    for(int p = 0; p < 6; p++)
+    {
+        // The corner furthest along the plane normal.
+        float d = myPlanes[p][3];
+        for(int c = 0; c < 3; c++)
+            d += myPlanes[p][c] * (myPlanes[p][c] > 0 ? max[c] : min[c]);
+        if(d < 0)
+            return false;
+    }
+    return true;
+}
+
+void Frustum::Multiply(const float *a, const float *b, float *result)
+{
+    for(int col = 0; col < 4; col++)
+    {
+        for(int row = 0; row < 4; row++)
+        {
+            float sum = 0;
+            for(int i = 0; i < 4; i++)
+                sum += a[i*4+row] * b[col*4+i];
+            result[col*4+row] = sum;
+        }
+    }
+}
@@ -0,0 +1,24 @@
+#ifndef FRUSTUM_H_
+#define FRUSTUM_H_
+
+/** View frustum planes of a clip-space transform.
+ * Built from a column-major 4x4 matrix, the layout GL uses for uniforms,
+ * mapping the space of the boxes tested into clip space.
+ */
+class Frustum
+{
+    float myPlanes[6][4];
+    public:
+    Frustum(const float *matrix);
+    ~Frustum() { }
+
+    /** False only if the axis-aligned box is entirely outside one plane.
+     */
+    bool Intersects(const float *min, const float *max) const;
+
+    /** Column-major \a a * \a b into \a result.
+     */
+    static void Multiply(const float *a, const float *b, float *result);
+};
+
+#endif
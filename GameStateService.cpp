@@ -1,9 +1,14 @@
 #include "GameStateService.h"
 #include "entity/Billboard.h"
 #include "MortarAnimation.h"
+#include <cmath>
 
 #define XOR(p1, p2) ((p1 || p2) && !(p1 && p2))
 
+const real GameStateService::TurboFrameTime = 10;
+const real GameStateService::MaxAspect = 2;
+const real GameStateService::CullMargin = 2;
+
 void GameStateService::Player::Update(const PlayerState &other)
 {
     if(Name != other.Name)
@@ -53,7 +58,8 @@ GameStateService::GameStateService(MultiContainer *container, Hexmap *map,
     myActionCount(0), myActionCursor(0), myAnimatingDying(false), 
     myCamera(camera), myLaser(laserTexture), myMortar(mortarTexture), 
     myInMortar(false), myDroid(droidTexture), myDroidSequenceCounter(-1), 
-    myDoExplode(false), myExplosion(explosionTexture), myIcon(iconTexture)
+    myDoExplode(false), myExplosion(explosionTexture), myIcon(iconTexture),
+    myTurbo(false)
 {
     RegisterInPin(SkyportEventClass::GameState, "StateUpdates", 
             static_cast<EventCallback>(&GameStateService::StateUpdate));
@@ -194,8 +200,110 @@ bool GameStateService::ForceMoveCamera(real angle, real time, real dragTime, rea
     }
 }
 
+void GameStateService::UpdateVisibility()
+{
+    if(Turn == -1)
+        return;
+    VectorF4 cam, target;
+    myCamMov.Transform.Get().GetTranslation(cam);
+    myCamMarkerMov.Transform.Get().GetTranslation(target);
+
+    // Camera basis, the camera points at the marker with Y up.
+    real forward[3] = { target[X] - cam[X], target[Y] - cam[Y], target[Z] - cam[Z] };
+    real length = sqrt(forward[0]*forward[0] + forward[1]*forward[1] + forward[2]*forward[2]);
+    if(length < 1e-5)
+        return;
+    for(int i = 0; i < 3; i++)
+        forward[i] /= length;
+    real right[3] = { -forward[2], 0, forward[0] };
+    length = sqrt(right[0]*right[0] + right[2]*right[2]);
+    if(length < 1e-5)
+    {
+        right[0] = 1;
+        right[2] = 0;
+    }
+    else
+    {
+        right[0] /= length;
+        right[2] /= length;
+    }
+    real up[3] = {
+        right[1]*forward[2] - right[2]*forward[1],
+        right[2]*forward[0] - right[0]*forward[2],
+        right[0]*forward[1] - right[1]*forward[0]
+    };
+
+    // Rectangle on the ground (XZ) holding the footprint of the frustum:
+    // each corner ray ends where it hits the ground or at the far plane.
+    real tanY = tan(myCamera->FOV.Get() / 2);
+    real tanX = tanY * MaxAspect;
+    real far = myCamera->Far.Get();
+    real minX = cam[X], maxX = cam[X], minZ = cam[Z], maxZ = cam[Z];
+    for(int corner = 0; corner < 4; corner++)
+    {
+        real sx = corner & 1 ? 1 : -1;
+        real sy = corner & 2 ? 1 : -1;
+        real ray[3];
+        for(int i = 0; i < 3; i++)
+            ray[i] = forward[i] + up[i]*tanY*sy + right[i]*tanX*sx;
+        real t = far;
+        if(ray[1] < -1e-5)
+            t = std::min(t, -cam[Y] / ray[1]);
+        minX = std::min(minX, cam[X] + ray[0]*t);
+        maxX = std::max(maxX, cam[X] + ray[0]*t);
+        minZ = std::min(minZ, cam[Z] + ray[2]*t);
+        maxZ = std::max(maxZ, cam[Z] + ray[2]*t);
+    }
+    minX -= CullMargin;
+    maxX += CullMargin;
+    minZ -= CullMargin;
+    maxZ += CullMargin;
+
+    // Invert TileToPosition for the corners of the rectangle to get the
+    // range of tiles covering it.
+    const VectorF2 &jo = Hexmap::jOffset;
+    const VectorF2 &ko = Hexmap::kOffset;
+    real det = jo[X]*ko[Y] - ko[X]*jo[Y];
+    real minJ = 1e30, maxJ = -1e30, minK = 1e30, maxK = -1e30;
+    for(int corner = 0; corner < 4; corner++)
+    {
+        real x = corner & 1 ? maxX : minX;
+        real z = corner & 2 ? maxZ : minZ;
+        real j = (x*ko[Y] - ko[X]*z) / det;
+        real k = (jo[X]*z - x*jo[Y]) / det;
+        minJ = std::min(minJ, j);
+        maxJ = std::max(maxJ, j);
+        minK = std::min(minK, k);
+        maxK = std::max(maxK, k);
+    }
+    Hexmap::TileRange range = myMap->SetVisibleRange(Hexmap::TileRange(
+                int(floor(minJ)), int(ceil(maxJ)),
+                int(floor(minK)), int(ceil(maxK))));
+    myMap->UpdateView(cam);
+    uint visible = range.Count();
+    uint culled = myMap->GetJLength() * myMap->GetKLength() - visible;
+
+    for(auto pit = Players.begin(); pit != Players.end(); pit++)
+    {
+        VectorF4 pos;
+        pit->PlayerMovable->Transform.Get().GetTranslation(pos);
+        bool inside = pos[X] >= minX && pos[X] <= maxX &&
+            pos[Z] >= minZ && pos[Z] <= maxZ;
+        pit->PlayerVisual->Culled = !inside;
+        pit->PlayerNametag->Culled = !inside;
+        if(inside)
+            visible += 2;
+        else
+            culled += 2;
+    }
+    RenderStats::CountVisibility(visible, culled);
+}
+
 void GameStateService::Update(const GameState &state)
 {
+    Profiler::Scope scope(Profiler::Update);
+    if(Turn != state.GetTurn())
+        Profiler::Count(Profiler::Turns);
     VectorI2 mapSize = state.GetMap().GetSize();
     if(Turn == -1)
     {
@@ -204,7 +312,7 @@ void GameStateService::Update(const GameState &state)
                 pit != state.Players_end(); pit++)
         {
             Movable *mov = new Movable();
-            Billboard *bill = new Billboard(myFigureTexture);
+            CulledBillboard *bill = new CulledBillboard(myFigureTexture);
             bill->SetProgram(myPlayerProgram);
             Movable *nameMov = new Movable();
             MultiContainer *container = new MultiContainer();
@@ -588,6 +696,7 @@ void GameStateService::PlayDroid()
 
 void GameStateService::PlayAnimation()
 {
+    Profiler::Scope scope(Profiler::PlayAnimation);
     if(myAnimations.GetNonPermanentCount() == 0)
     {
         if(myDyingPlayers.size() != 0)
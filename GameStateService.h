@@ -10,18 +10,31 @@
 #include "GameState.h"
 #include "Statusbox.h"
 #include "Nametag.h"
+#include "CulledBillboard.h"
 #include "Textbox.h"
 #include "Hexmap.h"
 #include "Laser.h"
 #include "Meteor.h"
 #include "SoundManager.h"
 #include "Fader.h"
+#include "Profiler.h"
 
 using namespace anengine;
 
 class GameStateService : public Service, public AnimationHelperListner
 {
     static const uint MeteorCount = 1;
+    /** Widest aspect ratio the visibility pass allows for.
+     */
+    static const real MaxAspect;
+    /** How far outside the ground footprint of the view something may be
+     * and still reach into it, covering tile radius and billboard height.
+     */
+    static const real CullMargin;
+    /** Frame time fed to the animations in turbo mode. Longer than any
+     * non-permanent animation, so each one finishes on its first update.
+     */
+    static const real TurboFrameTime;
     struct Player
     {
         uint Index;
@@ -30,7 +43,7 @@ class GameStateService : public Service, public AnimationHelperListner
         uint Score;
         VectorI2 Position;
         Movable *PlayerMovable;
-        Visual *PlayerVisual;
+        CulledBillboard *PlayerVisual;
         Movable *NametagMovable;
         MultiContainer *PlayerContainer;
         Nametag *PlayerNametag;
@@ -39,7 +52,7 @@ class GameStateService : public Service, public AnimationHelperListner
         bool Spawned;
 
         Player(uint index, std::string name, Movable *playerMovable, 
-                Visual *playerVisual, Movable *nametagMovable,
+                CulledBillboard *playerVisual, Movable *nametagMovable,
                 MultiContainer *playerContainer, Nametag *nametag)
             : Index(index), Name(name), 
             Health(0), Score(0), Position(ZeroI2), 
@@ -129,10 +142,13 @@ class GameStateService : public Service, public AnimationHelperListner
 
     Fader myFader;
 
+    bool myTurbo;
+
     void SetCurrentPlayer();
     bool StateUpdate(Event &event, InPin pin);
     void PlayAnimation();
     void MoveCamera(real angle = 0, real time = 1, real dragTime = 0.5);
+    void UpdateVisibility();
     bool ForceMoveCamera(real angle = 0, real time = 1, real dragTime = 0.5, real height = 10);
     void PlaySound(Sound sound, real duration = 0);
     void Explode(VectorF4 pos);
@@ -148,10 +164,22 @@ class GameStateService : public Service, public AnimationHelperListner
             Camera *camera);
 
     virtual ~GameStateService();
+
+    /** Play every animation in a single frame, for benchmarking.
+     */
+    void SetTurbo(bool turbo)
+    {
+        myTurbo = turbo;
+    }
     
     virtual void OnUpdate(FrameTime time)
     {
-        myAnimations.Update(time);
+        Profiler::Scope scope(Profiler::Animate);
+        if(myTurbo)
+            myAnimations.Update(TurboFrameTime);
+        else
+            myAnimations.Update(time);
+        UpdateVisibility();
     }
 };
 
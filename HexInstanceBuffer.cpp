@@ -0,0 +1,114 @@
+#include "HexInstanceBuffer.h"
+#include "RenderStats.h"
+#include <algorithm>
+#include <cstddef>
+
+void HexInstanceBuffer::MarkDirty(uint index)
+{
+    if(myDirtyBegin == myDirtyEnd)
+    {
+        myDirtyBegin = index;
+        myDirtyEnd = index + 1;
+    }
+    else
+    {
+        myDirtyBegin = std::min(myDirtyBegin, index);
+        myDirtyEnd = std::max(myDirtyEnd, index + 1);
+    }
+}
+
+void HexInstanceBuffer::Resize(uint count)
+{
+    Instance empty = { { 0, 0 }, 0, 0, { 0, 0, 0, 0 } };
+    myInstances.assign(count, empty);
+    myDirtyBegin = 0;
+    myDirtyEnd = count;
+}
+
+void HexInstanceBuffer::SetTransform(uint index, VectorF2 position, real rotation)
+{
+    Instance &instance = myInstances[index];
+    instance.Position[0] = position[X];
+    instance.Position[1] = position[Y];
+    instance.Rotation = rotation;
+    MarkDirty(index);
+}
+
+void HexInstanceBuffer::SetType(uint index, uint type, const ColorF &color)
+{
+    Instance &instance = myInstances[index];
+    if(instance.Type == type && instance.Color[3] == color[A] &&
+            instance.Color[0] == color[R] && instance.Color[1] == color[G] &&
+            instance.Color[2] == color[B])
+        return;
+    instance.Type = type;
+    instance.Color[0] = color[R];
+    instance.Color[1] = color[G];
+    instance.Color[2] = color[B];
+    instance.Color[3] = color[A];
+    MarkDirty(index);
+}
+
+void HexInstanceBuffer::Upload()
+{
+    if(myBuffer == 0)
+        glGenBuffers(1, &myBuffer);
+    glBindBuffer(GL_ARRAY_BUFFER, myBuffer);
+    if(myBufferSize != myInstances.size())
+    {
+        myBufferSize = myInstances.size();
+        RenderStats::BufferData(GL_ARRAY_BUFFER, myBufferSize * sizeof(Instance),
+                myInstances.empty() ? NULL : &myInstances[0], GL_DYNAMIC_DRAW);
+    }
+    else if(myDirtyBegin != myDirtyEnd)
+    {
+        RenderStats::BufferSubData(GL_ARRAY_BUFFER, myDirtyBegin * sizeof(Instance),
+                (myDirtyEnd - myDirtyBegin) * sizeof(Instance),
+                &myInstances[myDirtyBegin]);
+    }
+    myDirtyBegin = myDirtyEnd = 0;
+}
+
+void HexInstanceBuffer::Bind(GLint instanceAttrib, GLint colorAttrib, uint first)
+{
+    size_t base = first * sizeof(Instance);
+    glBindBuffer(GL_ARRAY_BUFFER, myBuffer);
+    if(instanceAttrib != -1)
+    {
+        glEnableVertexAttribArray(instanceAttrib);
+        glVertexAttribPointer(instanceAttrib, 4, GL_FLOAT, GL_FALSE,
+                sizeof(Instance), (const GLvoid*)(base + offsetof(Instance, Position)));
+        glVertexAttribDivisor(instanceAttrib, 1);
+    }
+    if(colorAttrib != -1)
+    {
+        glEnableVertexAttribArray(colorAttrib);
+        glVertexAttribPointer(colorAttrib, 4, GL_FLOAT, GL_FALSE,
+                sizeof(Instance), (const GLvoid*)(base + offsetof(Instance, Color)));
+        glVertexAttribDivisor(colorAttrib, 1);
+    }
+}
+
+void HexInstanceBuffer::Unbind(GLint instanceAttrib, GLint colorAttrib)
+{
+    if(instanceAttrib != -1)
+    {
+        glVertexAttribDivisor(instanceAttrib, 0);
+        glDisableVertexAttribArray(instanceAttrib);
+    }
+    if(colorAttrib != -1)
+    {
+        glVertexAttribDivisor(colorAttrib, 0);
+        glDisableVertexAttribArray(colorAttrib);
+    }
+}
+
+void HexInstanceBuffer::Release()
+{
+    if(myBuffer != 0)
+        glDeleteBuffers(1, &myBuffer);
+    myBuffer = 0;
+    myBufferSize = 0;
+    myDirtyBegin = 0;
+    myDirtyEnd = myInstances.size();
+}
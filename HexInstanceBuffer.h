@@ -0,0 +1,63 @@
+#ifndef HEXINSTANCEBUFFER_H_
+#define HEXINSTANCEBUFFER_H_
+
+#include <vector>
+#include <GL/glew.h>
+#include "math/Vector.h"
+
+using namespace anengine;
+
+/** Per-tile instance data for the instanced hexmap path.
+ * Kept on the CPU and mirrored into one GL buffer. Changes are collected
+ * into a single dirty range that is uploaded with one glBufferSubData the
+ * next time the buffer is used for drawing.
+ */
+class HexInstanceBuffer
+{
+    public:
+    struct Instance
+    {
+        GLfloat Position[2];
+        GLfloat Rotation;
+        GLfloat Type;
+        GLfloat Color[4];
+    };
+
+    private:
+    std::vector<Instance> myInstances;
+    GLuint myBuffer;
+    uint myBufferSize;
+    uint myDirtyBegin;
+    uint myDirtyEnd;
+
+    void MarkDirty(uint index);
+
+    public:
+    HexInstanceBuffer()
+        : myBuffer(0), myBufferSize(0), myDirtyBegin(0), myDirtyEnd(0) { }
+    ~HexInstanceBuffer() { }
+
+    void Resize(uint count);
+    void SetTransform(uint index, VectorF2 position, real rotation);
+    void SetType(uint index, uint type, const ColorF &color);
+
+    uint Count() const
+    {
+        return myInstances.size();
+    }
+
+    /** Upload pending changes. Must be called with the context current.
+     */
+    void Upload();
+    /** Point \a instanceAttrib and \a colorAttrib at the instance data,
+     * starting at instance \a first, with a divisor of one. Attributes the
+     * program does not use are -1.
+     */
+    void Bind(GLint instanceAttrib, GLint colorAttrib, uint first = 0);
+    void Unbind(GLint instanceAttrib, GLint colorAttrib);
+    /** Delete the GL buffer, must be called with the context current.
+     */
+    void Release();
+};
+
+#endif
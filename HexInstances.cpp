@@ -0,0 +1,113 @@
+#include "HexInstances.h"
+#include "AssetBundle.h"
+#include "entity/SceneGraph.h"
+#include <algorithm>
+
+StaticAsset<VertexBuffer> HexInstances::myVertexBuffers[KindCount] = {
+    AssetBundle::Static<VertexBuffer>("assets/geometry/hextile.gen.vbo"),
+    AssetBundle::Static<VertexBuffer>("assets/geometry/hexborder.gen.vbo"),
+    AssetManager::CreateStaticFromMemory<VertexBuffer>(
+"A2 position float2 false 16 0 texcoord float2 false 16 8 1 24"
+"-0.5 -0.5 0.0 0.0 "
+" 0.5 -0.5 1.0 0.0 "
+" 0.5  0.5 1.0 1.0 "
+"-0.5 -0.5 0.0 0.0 "
+" 0.5  0.5 1.0 1.0 "
+"-0.5  0.5 0.0 1.0 "),
+    AssetManager::CreateStaticFromMemory<VertexBuffer>(
+"A2 position float2 false 16 0 texcoord float2 false 16 8 1 24"
+"-0.5 -0.5 0.0 0.0 "
+" 0.5 -0.5 1.0 0.0 "
+" 0.5  0.5 1.0 1.0 "
+"-0.5 -0.5 0.0 0.0 "
+" 0.5  0.5 1.0 1.0 "
+"-0.5  0.5 0.0 1.0 ")
+};
+
+StaticAsset<Program> HexInstances::myPrograms[KindCount] = {
+    AssetBundle::Static<Program>("assets/shaders/GroundInstanced.sp"),
+    AssetBundle::Static<Program>("assets/shaders/HexborderInstanced.sp"),
+    AssetBundle::Static<Program>("assets/shaders/EmblemInstanced.sp"),
+    AssetBundle::Static<Program>("assets/shaders/EmblemInstanced.sp")
+};
+
+const GLsizei HexInstances::myVertexCounts[KindCount] = { 48, 36, 6, 6 };
+
+void HexInstances::OnCreate()
+{
+    myTexture = myTextureRef;
+    if(!HasProgram())
+    {
+        AssetRef<Program> program = myPrograms[myKind].Get(Scene.Get()->GetAssetManager());
+        if(myKind == SpawnEmblems)
+            SetProgram(program, program->CreateState());
+        else
+            SetProgram(program);
+    }
+    if(myKind == SpawnEmblems)
+        Pass.Set(1);
+    FixedGeometry::OnCreate();
+}
+
+void HexInstances::OnDestroy()
+{
+    myTexture.Release();
+    myProgramId = 0;
+    FixedGeometry::OnDestroy();
+}
+
+void HexInstances::OnNewProgram()
+{
+    if(!myTexture.Empty())
+        ProgramState().SetUniform("Texture", myTexture);
+    if(myKind == SpawnEmblems)
+        ProgramState().SetUniform("SpawnPass", 1.0f);
+    ApplyLod();
+    FixedGeometry::OnNewProgram();
+}
+
+void HexInstances::SetLod(const VectorF4 &camera, real emblemDistance,
+        real borderDistance)
+{
+    myCameraPosition = camera;
+    myEmblemDistance = emblemDistance;
+    myBorderDistance = borderDistance;
+    if(HasProgram())
+        ApplyLod();
+}
+
+void HexInstances::ApplyLod()
+{
+    ProgramState().SetUniform("CameraPosition", myCameraPosition);
+    if(myKind == Emblems || myKind == SpawnEmblems)
+        ProgramState().SetUniform("EmblemDistance", myEmblemDistance);
+    else
+        ProgramState().SetUniform("BorderDistance", myBorderDistance);
+}
+
+void HexInstances::OnDraw(FrameTime elapsed)
+{
+    if(myFirst >= myInstances->Count() || myCount == 0)
+        return;
+    uint count = std::min(myCount, myInstances->Count() - myFirst);
+
+    // The engine binds the program and the per-vertex attributes, the
+    // instance attributes are looked up once per program.
+    GLint program = 0;
+    glGetIntegerv(GL_CURRENT_PROGRAM, &program);
+    if(program != myProgramId)
+    {
+        myProgramId = program;
+        myInstanceAttrib = glGetAttribLocation(program, "Instance");
+        myColorAttrib = glGetAttribLocation(program, "InstanceColor");
+    }
+
+    GLint arrayBuffer = 0;
+    glGetIntegerv(GL_ARRAY_BUFFER_BINDING, &arrayBuffer);
+    myInstances->Upload();
+    myInstances->Bind(myInstanceAttrib, myColorAttrib, myFirst);
+    RenderStats::DrawArraysInstanced(GL_TRIANGLES, 0,
+            myVertexCounts[myKind], count);
+    myInstances->Unbind(myInstanceAttrib, myColorAttrib);
+    glBindBuffer(GL_ARRAY_BUFFER, arrayBuffer);
+}
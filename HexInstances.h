@@ -0,0 +1,79 @@
+#ifndef HEXINSTANCES_H_
+#define HEXINSTANCES_H_
+
+#include "entity/FixedGeometry.h"
+#include "assets/AssetManager.h"
+#include "HexInstanceBuffer.h"
+#include "RenderStats.h"
+
+using namespace anengine;
+
+/** Draws one layer of the whole hexmap with a single instanced draw call.
+ * The per-tile transform and type come from a HexInstanceBuffer shared by
+ * all layers of the map.
+ */
+class HexInstances : public FixedGeometry
+{
+    public:
+    enum Kind
+    {
+        Tiles,
+        Borders,
+        Emblems,
+        SpawnEmblems,
+        KindCount
+    };
+    private:
+    static StaticAsset<VertexBuffer> myVertexBuffers[KindCount];
+    static StaticAsset<Program> myPrograms[KindCount];
+    static const GLsizei myVertexCounts[KindCount];
+
+    Kind myKind;
+    HexInstanceBuffer *myInstances;
+    AssetRef<Texture> myTextureRef;
+    Asset<Texture> myTexture;
+    GLint myProgramId;
+    GLint myInstanceAttrib;
+    GLint myColorAttrib;
+    uint myFirst;
+    uint myCount;
+    VectorF4 myCameraPosition;
+    real myEmblemDistance;
+    real myBorderDistance;
+
+    void ApplyLod();
+
+    protected:
+    virtual AssetRef<VertexBuffer> GetGeometry(AssetManager *manager)
+    {
+        return myVertexBuffers[myKind].Get(manager);
+    }
+    virtual void OnDraw(FrameTime elapsed);
+    virtual void OnNewProgram();
+    virtual void OnCreate();
+    virtual void OnDestroy();
+
+    public:
+    HexInstances(Kind kind, HexInstanceBuffer *instances,
+            AssetRef<Texture> texture = AssetRef<Texture>())
+        : myKind(kind), myInstances(instances), myTextureRef(texture),
+        myProgramId(0), myInstanceAttrib(-1), myColorAttrib(-1),
+        myFirst(0), myCount(-1), myCameraPosition(0, 0, 0),
+        myEmblemDistance(1e6), myBorderDistance(1e6) { }
+    virtual ~HexInstances() { }
+
+    /** Only draw \a count instances starting at \a first.
+     */
+    void SetRange(uint first, uint count)
+    {
+        myFirst = first;
+        myCount = count;
+    }
+
+    /** Emblems further than \a emblemDistance from \a camera are dropped
+     * and borders further than \a borderDistance are painted by the tiles.
+     */
+    void SetLod(const VectorF4 &camera, real emblemDistance, real borderDistance);
+};
+
+#endif
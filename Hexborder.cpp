@@ -1,5 +1,6 @@
 #include "Hexborder.h"
+#include "AssetBundle.h"
 #include "assets/AssetManager.h"
 
-StaticAsset<VertexBuffer> Hexborder::myVertexBuffer(AssetManager
-            ::CreateStaticFromFile<VertexBuffer>("assets/geometry/hexborder.gen.vbo"));
+StaticAsset<VertexBuffer> Hexborder::myVertexBuffer(AssetBundle
+            ::Static<VertexBuffer>("assets/geometry/hexborder.gen.vbo"));
@@ -3,6 +3,7 @@
 
 #include "entity/FixedGeometry.h"
 #include "assets/AssetManager.h"
+#include "RenderStats.h"
 
 using namespace anengine;
 
@@ -16,7 +17,7 @@ class Hexborder : public FixedGeometry
     }
     virtual void OnDraw(FrameTime elapsed)
     {
-        glDrawArrays(GL_TRIANGLES, 0, 36);
+        RenderStats::DrawArrays(GL_TRIANGLES, 0, 36);
     }
 
     public:
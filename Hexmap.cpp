@@ -1,22 +1,41 @@
 #include "Hexmap.h"
+#include "AssetBundle.h"
+#include "RenderStats.h"
+#include "VertexFile.h"
 #include <cstdlib>
+#include <algorithm>
+#include <cmath>
 
 const real Hexmap::TileDistance = 0.05f;
-StaticAsset<Program> Hexmap::myHexborderProgramRef(AssetManager
-            ::CreateStaticFromFile<Program>("assets/shaders/hexborder.sp"));
-StaticAsset<Program> Hexmap::myHextileProgramRef(AssetManager
-            ::CreateStaticFromFile<Program>("assets/shaders/Ground.sp"));
+StaticAsset<Program> Hexmap::myHexborderProgramRef(AssetBundle
+            ::Static<Program>("assets/shaders/hexborder.sp"));
+StaticAsset<Program> Hexmap::myHextileProgramRef(AssetBundle
+            ::Static<Program>("assets/shaders/Ground.sp"));
 const VectorF2 Hexmap::jOffset( (1.5+TileDistance),-(0.87+TileDistance));
 const VectorF2 Hexmap::kOffset(-(1.5+TileDistance),-(0.87+TileDistance));
+const real Hexmap::DefaultEmblemDistance = 35;
+const real Hexmap::DefaultBorderDistance = 25;
 
-Hexmap::Hexmap(AssetRef<Texture> baseTexture, AssetRef<Texture> emblemTexture)
-    : myHextiles(NULL), myBaseTextureRef(baseTexture), 
-    myEmblemTextureRef(emblemTexture) { }
+Hexmap::Hexmap(AssetRef<Texture> baseTexture, AssetRef<Texture> emblemTexture,
+        RenderPath path)
+    : myRenderPath(path), myGroundSlots(NULL), myEmblems(NULL),
+    myTileInstances(HexInstances::Tiles, &myInstances, baseTexture),
+    myBorderInstances(HexInstances::Borders, &myInstances),
+    myEmblemInstances(HexInstances::Emblems, &myInstances, emblemTexture),
+    mySpawnEmblemInstances(HexInstances::SpawnEmblems, &myInstances, emblemTexture),
+    myInstancesAdded(false), myChunkSize(0),
+    myEmblemDistance(DefaultEmblemDistance),
+    myBorderDistance(DefaultBorderDistance),
+    myJLength(0), myKLength(0),
+    myBaseTextureRef(baseTexture), myEmblemTextureRef(emblemTexture) { }
 
 Hexmap::~Hexmap()
 {
-    if(myHextiles != NULL)
-        delete [] myHextiles;
+    if(myGroundSlots != NULL)
+        delete [] myGroundSlots;
+    if(myEmblems != NULL)
+        delete [] myEmblems;
+    DeleteChunks();
 }
 
 void Hexmap::Create(int jSize, int kSize)
@@ -28,35 +47,96 @@ void Hexmap::Create(int jSize, int kSize)
     else
         if(Parent.Get()->Scene.Get() == NULL)
             Debug("Hexmap parent has no scene!");
-    if(myHextiles != NULL)
-        delete [] myHextiles;
+    if(myGroundSlots != NULL)
+        delete [] myGroundSlots;
+    if(myEmblems != NULL)
+        delete [] myEmblems;
+    myGroundSlots = NULL;
+    myEmblems = NULL;
 
     myJLength = jSize;
     myKLength = kSize;
-    myHextiles = new TileData[jSize*kSize];
-
+    uint count = jSize*kSize;
+    myTileTypes.assign(count, 0);
+    myVisible = TileRange(0, jSize - 1, 0, kSize - 1);
+    myTileRotations.resize(count);
     for(int j = 0; j < jSize; j++)
-    {
         for(int k = 0; k < kSize; k++)
+            myTileRotations[Index(j,k)] = rand()%6*Pi/3;
+
+    if(myRenderPath != Entities)
+    {
+        CreateInstances();
+        if(myRenderPath != Instanced)
+            CreateBaked();
+        return;
+    }
+
+    myGroundSlots = new GroundSlot[count];
+    myEmblems = new EmblemSlot[count];
+    myEmblemHidden.assign(count, false);
+    myQueue.Reset(count, TileTypeCount);
+
+    for(uint i = 0; i < count; i++)
+    {
+        GroundSlot &slot = myGroundSlots[i];
+        slot.TileMov.SetChild(&(slot.Tile));
+        slot.BorderMov.SetChild(&(slot.Border));
+        EmblemSlot &emblem = myEmblems[i];
+        emblem.Mov.Transform.Set(TileTransform(i));
+        //emblem.EmblemMove.Transform.Set(MatrixF4::Translation(VectorF4(0,0,0.5)));
+        //emblem.EmblemMove.SetChild(&(emblem.Emblem));
+        emblem.Mov.SetChild(&(emblem.Emblem));
+        // Programs only exist once created; a headless map has none.
+        if(IsCreated())
+        {
+            slot.Tile.SetProgram(myHextileProgram, myHextileProgramStates[0]);
+            slot.Border.SetProgram(myHexborderProgram, myHexborderProgramStates[0]);
+            emblem.Emblem.SetProgram(myEmblemProgram, myEmblemProgramStates[0]);
+        }
+        slot.TileMov.Transform.Set(TileTransform(i));
+        slot.BorderMov.Transform.Set(TileTransform(i));
+    }
+    for(uint i = 0; i < count; i++)
+        AddChild(&(myGroundSlots[i].TileMov));
+    for(uint i = 0; i < count; i++)
+        AddChild(&(myGroundSlots[i].BorderMov));
+    for(uint i = 0; i < count; i++)
+        AddChild(&(myEmblems[i].Mov));
+}
+
+MatrixF4 Hexmap::TileTransform(uint tile)
+{
+    VectorF2 center = TileCenter(tile % myJLength, tile / myJLength);
+    return MatrixF4::Translation(VectorF4(center[X], center[Y], 0))*
+        MatrixF4::RotationZ(myTileRotations[tile]);
+}
+
+void Hexmap::CreateInstances()
+{
+    myInstances.Resize(myJLength*myKLength);
+    myTileInstances.SetRange(0, myJLength*myKLength);
+    myBorderInstances.SetRange(0, myJLength*myKLength);
+    myEmblemInstances.SetRange(0, myJLength*myKLength);
+    mySpawnEmblemInstances.SetRange(0, myJLength*myKLength);
+    for(int j = 0; j < myJLength; j++)
+    {
+        for(int k = 0; k < myKLength; k++)
+        {
+            myInstances.SetTransform(Index(j,k), TileCenter(j,k),
+                    myTileRotations[Index(j,k)]);
+        }
+    }
+    if(!myInstancesAdded)
+    {
+        if(myRenderPath == Instanced)
         {
-            VectorF4 mjOffset(-jOffset[X],jOffset[Y],0);
-            VectorF4 mkOffset(-kOffset[X],kOffset[Y],0);
-
-            TileData &tile = myHextiles[Index(j,k)];
-            tile.Mov.Transform.Set(MatrixF4::Translation(mjOffset*j+mkOffset*k)*
-                    MatrixF4::RotationZ(rand()%6*Pi/3));
-            tile.Mov.SetChild(&(tile.TileContainer));
-            //tile.EmblemMove.Transform.Set(MatrixF4::Translation(VectorF4(0,0,0.5)));
-            //tile.EmblemMove.SetChild(&(tile.Emblem));
-            tile.TileContainer.AddChild(&(tile.Tile));
-            tile.TileContainer.AddChild(&(tile.Emblem));
-            tile.TileContainer.AddChild(&(tile.Border));
-            tile.Tile.SetProgram(myHextileProgram, myHextileProgramStates[0]);
-            tile.Border.SetProgram(myHexborderProgram, myHexborderProgramStates[0]);
-            tile.Emblem.SetProgram(myEmblemProgram, myEmblemProgramStates[0]);
-            tile.Type = 0;
-            AddChild(&(tile.Mov));
+            AddChild(&myTileInstances);
+            AddChild(&myBorderInstances);
         }
+        AddChild(&myEmblemInstances);
+        AddChild(&mySpawnEmblemInstances);
+        myInstancesAdded = true;
     }
 }
 
@@ -93,6 +173,62 @@ static const ColorF HexborderColors[Hexmap::TileTypeCount] = {
     ColorF(0.44, 0.40, 0.16, 1)  // explosium
 };
 
+void Hexmap::CreateBaked()
+{
+    // Kept for the whole run, the meshes bake from the mapped floats.
+    static const VertexFile *tileTemplate(
+            VertexFile::Load("assets/geometry/hextile.gen.vbo"));
+    static const VertexFile *borderTemplate(
+            VertexFile::Load("assets/geometry/hexborder.gen.vbo"));
+
+    DeleteChunks();
+    if(myRenderPath == Chunked)
+        myChunkSize = ChunkSize;
+    else
+        myChunkSize = std::max(std::max(myJLength, myKLength), 1);
+
+    for(int kBegin = 0; kBegin < myKLength; kBegin += myChunkSize)
+    {
+        for(int jBegin = 0; jBegin < myJLength; jBegin += myChunkSize)
+        {
+            MeshChunk chunk;
+            chunk.JBegin = jBegin;
+            chunk.KBegin = kBegin;
+            chunk.JSize = std::min(myChunkSize, myJLength - jBegin);
+            chunk.KSize = std::min(myChunkSize, myKLength - kBegin);
+
+            std::vector<VectorF2> centers;
+            std::vector<real> rotations;
+            for(int k = kBegin; k < kBegin + chunk.KSize; k++)
+            {
+                for(int j = jBegin; j < jBegin + chunk.JSize; j++)
+                {
+                    centers.push_back(TileCenter(j,k));
+                    rotations.push_back(myTileRotations[Index(j,k)]);
+                }
+            }
+            chunk.Mesh = new HexmapMesh(tileTemplate->Data(),
+                    tileTemplate->FloatCount(), borderTemplate->Data(),
+                    borderTemplate->FloatCount());
+            chunk.Mesh->Bake(centers, rotations);
+            chunk.Geometry = new BakedHexmap(chunk.Mesh, myBaseTextureRef,
+                    HexborderColors, TileTypeCount);
+            AddChild(chunk.Geometry);
+            myChunks.push_back(chunk);
+        }
+    }
+}
+
+void Hexmap::DeleteChunks()
+{
+    for(uint i = 0; i < myChunks.size(); i++)
+    {
+        delete myChunks[i].Geometry;
+        delete myChunks[i].Mesh;
+    }
+    myChunks.clear();
+}
+
 void Hexmap::OnCreate()
 {
     myHextileProgram = myHextileProgramRef.Get(Scene.Get()->GetAssetManager());
@@ -107,6 +243,7 @@ void Hexmap::OnCreate()
         hstate.SetUniform("FrameCount", VectorI2(1,TileTypeCount));
         hstate.SetUniform("Frame", VectorI2(0,i));
         hstate.SetUniform("Texture", myBaseTexture);
+        hstate.SetUniform("BorderColor", HexborderColors[i]);
 
         myHexborderProgramStates[i] = myHexborderProgram->CreateState();
         Program::ProgramState &bstate = myHexborderProgram->GetState(myHexborderProgramStates[i]);
@@ -124,6 +261,7 @@ void Hexmap::OnCreate()
 
 void Hexmap::OnDestroy()
 {
+    myInstances.Release();
     myHextileProgram.Release();
     myHexborderProgram.Release();
     myEmblemProgram.Release();
@@ -135,24 +273,190 @@ void Hexmap::OnDestroy()
 
 void Hexmap::SetTileType(int j, int k, char type)
 {
-    if(j < 0 || j >= myJLength || k < 0 || k > myKLength)
+    if(j < 0 || j >= myJLength || k < 0 || k >= myKLength)
+        return;
+    if(myTileTypes[Index(j,k)] == type)
+        return;
+    myTileTypes[Index(j,k)] = type;
+    if(myRenderPath != Entities)
+    {
+        uint index = TypeToIndex(type);
+        myInstances.SetType(Index(j,k), index, HexborderColors[index]);
+        if(!myChunks.empty())
+        {
+            int chunksPerRow = (myJLength + myChunkSize - 1) / myChunkSize;
+            MeshChunk &chunk = myChunks[(k / myChunkSize) * chunksPerRow +
+                j / myChunkSize];
+            chunk.Mesh->SetType((k - chunk.KBegin) * chunk.JSize +
+                    j - chunk.JBegin, index);
+        }
+        return;
+    }
+    // Slots share programs and texture, only the type's state differs.
+    myMovedSlots.clear();
+    myQueue.SetState(Index(j,k), type == 0 ? 0 : TypeToIndex(type), myMovedSlots);
+    for(uint i = 0; i < myMovedSlots.size(); i++)
+        AssignSlot(myMovedSlots[i]);
+    ApplyTileStates(Index(j,k));
+    if(!myMovedSlots.empty())
+        RenderStats::CountReorder(myMovedSlots.size(), GroundStateChanges());
+}
+
+void Hexmap::ApplyTileStates(uint tile)
+{
+    char type = myTileTypes[tile];
+    if(!IsCreated() || type == 0)
         return;
-    myHextiles[Index(j,k)].Type = type;
-    myHextiles[Index(j,k)].Tile.SetProgramState(
-            myHextileProgramStates[TypeToIndex(type)]);
-    myHextiles[Index(j,k)].Border.SetProgramState(
-            myHexborderProgramStates[TypeToIndex(type)]);
-    myHextiles[Index(j,k)].Emblem.SetProgramState(
-            myEmblemProgramStates[TypeToIndex(type)]);
+    GroundSlot &slot = myGroundSlots[myQueue.Slot(tile)];
+    slot.Tile.SetProgramState(myHextileProgramStates[TypeToIndex(type)]);
+    slot.Border.SetProgramState(myHexborderProgramStates[TypeToIndex(type)]);
+    myEmblems[tile].Emblem.SetProgramState(myEmblemProgramStates[TypeToIndex(type)]);
     if(type == 'S')
     {
-        myHextiles[Index(j,k)].Emblem.Pass.Set(1);
+        myEmblems[tile].Emblem.Pass.Set(1);
+    }
+}
+
+void Hexmap::ApplyTileVisibility(uint tile, bool visible)
+{
+    GroundSlot &slot = myGroundSlots[myQueue.Slot(tile)];
+    slot.Tile.Visible.Set(visible);
+    slot.Border.Visible.Set(visible);
+    myEmblems[tile].Emblem.Visible.Set(visible && !myEmblemHidden[tile]);
+}
+
+void Hexmap::AssignSlot(uint slot)
+{
+    uint tile = myQueue.Id(slot);
+    GroundSlot &ground = myGroundSlots[slot];
+    ground.TileMov.Transform.Set(TileTransform(tile));
+    ground.BorderMov.Transform.Set(TileTransform(tile));
+    ApplyTileStates(tile);
+    ApplyTileVisibility(tile, myVisible.Contains(tile % myJLength, tile / myJLength));
+}
+
+void Hexmap::UpdateView(const VectorF4 &camera)
+{
+    UpdateLod(camera);
+}
+
+void Hexmap::UpdateLod(const VectorF4 &camera)
+{
+    myTileInstances.SetLod(camera, myEmblemDistance, myBorderDistance);
+    myBorderInstances.SetLod(camera, myEmblemDistance, myBorderDistance);
+    myEmblemInstances.SetLod(camera, myEmblemDistance, myBorderDistance);
+    mySpawnEmblemInstances.SetLod(camera, myEmblemDistance, myBorderDistance);
+
+    // Chunks merge their borders once their nearest point is far enough.
+    for(uint i = 0; i < myChunks.size(); i++)
+    {
+        MeshChunk &chunk = myChunks[i];
+        VectorF2 corners[4] = {
+            TilePosition(chunk.JBegin, chunk.KBegin),
+            TilePosition(chunk.JBegin + chunk.JSize - 1, chunk.KBegin),
+            TilePosition(chunk.JBegin, chunk.KBegin + chunk.KSize - 1),
+            TilePosition(chunk.JBegin + chunk.JSize - 1, chunk.KBegin + chunk.KSize - 1)
+        };
+        real minX = corners[0][X], maxX = minX, minZ = corners[0][Y], maxZ = minZ;
+        for(int c = 1; c < 4; c++)
+        {
+            minX = std::min(minX, corners[c][X]);
+            maxX = std::max(maxX, corners[c][X]);
+            minZ = std::min(minZ, corners[c][Y]);
+            maxZ = std::max(maxZ, corners[c][Y]);
+        }
+        real dx = std::max(std::max(minX - 1 - camera[X], camera[X] - maxX - 1), real(0));
+        real dz = std::max(std::max(minZ - 1 - camera[Z], camera[Z] - maxZ - 1), real(0));
+        real distance = sqrt(dx*dx + camera[Y]*camera[Y] + dz*dz);
+        chunk.Geometry->SetBorderMerge(distance > myBorderDistance);
+    }
+
+    if(myGroundSlots == NULL)
+        return;
+    // Entity borders are merged in the shaders, which only need to know
+    // where the camera is. Emblems use the engine's billboard program and
+    // are hidden here.
+    if(IsCreated())
+    {
+        for(uint i = 0; i < TileTypeCount; i++)
+        {
+            Program::ProgramState &hstate = myHextileProgram->GetState(myHextileProgramStates[i]);
+            hstate.SetUniform("CameraPosition", camera);
+            hstate.SetUniform("BorderDistance", myBorderDistance);
+            Program::ProgramState &bstate = myHexborderProgram->GetState(myHexborderProgramStates[i]);
+            bstate.SetUniform("CameraPosition", camera);
+            bstate.SetUniform("BorderDistance", myBorderDistance);
+        }
+    }
+    for(int k = myVisible.KMin; k <= myVisible.KMax; k++)
+    {
+        for(int j = myVisible.JMin; j <= myVisible.JMax; j++)
+        {
+            VectorF2 pos = TilePosition(j,k);
+            real dx = pos[X] - camera[X];
+            real dz = pos[Y] - camera[Z];
+            real distance = sqrt(dx*dx + camera[Y]*camera[Y] + dz*dz);
+            bool hidden = distance > myEmblemDistance;
+            if(hidden == myEmblemHidden[Index(j,k)])
+                continue;
+            myEmblemHidden[Index(j,k)] = hidden;
+            myEmblems[Index(j,k)].Emblem.Visible.Set(!hidden);
+        }
+    }
+}
+
+void Hexmap::SetTilesVisible(const TileRange &range, const TileRange &except,
+        bool visible)
+{
+    for(int k = range.KMin; k <= range.KMax; k++)
+    {
+        for(int j = range.JMin; j <= range.JMax; j++)
+        {
+            if(!except.Contains(j,k))
+                ApplyTileVisibility(Index(j,k), visible);
+        }
+    }
+}
+
+Hexmap::TileRange Hexmap::SetVisibleRange(TileRange range)
+{
+    range.JMin = std::max(range.JMin, 0);
+    range.KMin = std::max(range.KMin, 0);
+    range.JMax = std::min(range.JMax, myJLength - 1);
+    range.KMax = std::min(range.KMax, myKLength - 1);
+    if(range.Empty())
+        range = TileRange();
+    if(range == myVisible)
+        return range;
+
+    if(myGroundSlots != NULL)
+    {
+        SetTilesVisible(myVisible, range, false);
+        SetTilesVisible(range, myVisible, true);
+    }
+    myVisible = range;
+
+    // Instances are stored row by row in k, so the range becomes one span.
+    uint first = range.Empty() ? 0 : range.KMin * myJLength;
+    uint count = range.Empty() ? 0 : (range.KMax - range.KMin + 1) * myJLength;
+    myTileInstances.SetRange(first, count);
+    myBorderInstances.SetRange(first, count);
+    myEmblemInstances.SetRange(first, count);
+    mySpawnEmblemInstances.SetRange(first, count);
+
+    for(uint i = 0; i < myChunks.size(); i++)
+    {
+        MeshChunk &chunk = myChunks[i];
+        chunk.Geometry->Visible.Set(!range.Empty() &&
+                chunk.JBegin <= range.JMax && chunk.JBegin + chunk.JSize > range.JMin &&
+                chunk.KBegin <= range.KMax && chunk.KBegin + chunk.KSize > range.KMin);
     }
+    return range;
 }
 
 char Hexmap::GetTileType(int j, int k)
 {
     if(j < 0 || j >= myJLength || k < 0 || k >= myKLength)
         return 'V';
-    return myHextiles[Index(j,k)].Type;
+    return myTileTypes[Index(j,k)];
 }
@@ -5,23 +5,114 @@
 #include "Hextile.h"
 #include "Hexborder.h"
 #include "entity/Billboard.h"
+#include "HexInstanceBuffer.h"
+#include "HexInstances.h"
+#include "HexmapMesh.h"
+#include "BakedHexmap.h"
+#include "RenderQueue.h"
 
 class Hexmap : public MultiContainer
 {
     public:
     static const uint TileTypeCount = 7;
+    /** How the tiles are turned into draw calls.
+     */
+    enum RenderPath
+    {
+        /** One tile, border and emblem entity per tile, drawn as a layer
+         * of tiles, one of borders and one of emblems. */
+        Entities,
+        /** One instanced draw per layer for the whole map. */
+        Instanced,
+        /** Ground and borders baked into one static mesh, emblems instanced. */
+        Baked,
+        /** Like Baked, with one mesh per ChunkSize x ChunkSize tiles. */
+        Chunked
+    };
+    static const int ChunkSize = 16;
+    /** Inclusive rectangle of tiles in j/k, empty if a minimum exceeds
+     * its maximum.
+     */
+    struct TileRange
+    {
+        int JMin;
+        int JMax;
+        int KMin;
+        int KMax;
+
+        TileRange(int jMin = 0, int jMax = -1, int kMin = 0, int kMax = -1)
+            : JMin(jMin), JMax(jMax), KMin(kMin), KMax(kMax) { }
+
+        bool Contains(int j, int k) const
+        {
+            return j >= JMin && j <= JMax && k >= KMin && k <= KMax;
+        }
+        bool Empty() const
+        {
+            return JMin > JMax || KMin > KMax;
+        }
+        uint Count() const
+        {
+            return Empty() ? 0 : (JMax - JMin + 1) * (KMax - KMin + 1);
+        }
+        bool operator==(const TileRange &other) const
+        {
+            return JMin == other.JMin && JMax == other.JMax &&
+                KMin == other.KMin && KMax == other.KMax;
+        }
+    };
     private:
-    struct TileData
+    /** Draw slots of the entity path. The scene draws children in order,
+     * so every tile slot comes before every border slot, and those before
+     * the emblems. Tiles are assigned to ground slots grouped by type, so
+     * consecutive slots share their program state. Emblems are blended
+     * and stay in tile order.
+     */
+    struct GroundSlot
     {
-        char Type;
+        Movable TileMov;
         Hextile Tile;
+        Movable BorderMov;
         Hexborder Border;
-        Billboard Emblem;
+    };
+    struct EmblemSlot
+    {
         Movable Mov;
+        Billboard Emblem;
         //Movable EmblemMove;
-        MultiContainer TileContainer;
     };
-    TileData *myHextiles;
+    RenderPath myRenderPath;
+    GroundSlot *myGroundSlots;
+    EmblemSlot *myEmblems;
+    RenderQueue myQueue;
+    std::vector<uint> myMovedSlots;
+    std::vector<char> myTileTypes;
+    std::vector<real> myTileRotations;
+    HexInstanceBuffer myInstances;
+    HexInstances myTileInstances;
+    HexInstances myBorderInstances;
+    HexInstances myEmblemInstances;
+    HexInstances mySpawnEmblemInstances;
+    bool myInstancesAdded;
+    /** A rectangle of tiles with its own mesh, buffer and bounds.
+     */
+    struct MeshChunk
+    {
+        int JBegin;
+        int KBegin;
+        int JSize;
+        int KSize;
+        HexmapMesh *Mesh;
+        BakedHexmap *Geometry;
+    };
+    std::vector<MeshChunk> myChunks;
+    int myChunkSize;
+    TileRange myVisible;
+    /** Emblems of the entity path dropped by the level of detail.
+     */
+    std::vector<bool> myEmblemHidden;
+    real myEmblemDistance;
+    real myBorderDistance;
     int myJLength;
     int myKLength;
     static StaticAsset<Program> myHextileProgramRef;
@@ -39,6 +130,17 @@ class Hexmap : public MultiContainer
         return k * myJLength + j;
     }
 
+    void CreateInstances();
+    void CreateBaked();
+    void DeleteChunks();
+    void SetTilesVisible(const TileRange &range, const TileRange &except,
+            bool visible);
+    void ApplyTileVisibility(uint tile, bool visible);
+    void ApplyTileStates(uint tile);
+    void AssignSlot(uint slot);
+    void UpdateLod(const VectorF4 &camera);
+    MatrixF4 TileTransform(uint tile);
+
     /*virtual void OnCreate()
     {
         Debug("Hexmap created: %p",this);
@@ -53,13 +155,64 @@ class Hexmap : public MultiContainer
     static const real TileDistance;
     static const VectorF2 jOffset;
     static const VectorF2 kOffset;
-    Hexmap(AssetRef<Texture> baseTexture, AssetRef<Texture> emblemTexture);
+    static const real DefaultEmblemDistance;
+    static const real DefaultBorderDistance;
+    Hexmap(AssetRef<Texture> baseTexture, AssetRef<Texture> emblemTexture,
+            RenderPath path = Entities);
     virtual ~Hexmap();
 
     virtual void OnCreate();
     virtual void OnDestroy();
 
+    /** Center of tile (j, k) in the map's own coordinates.
+     */
+    static VectorF2 TileCenter(int j, int k)
+    {
+        return VectorF2(-jOffset[X]*j - kOffset[X]*k, jOffset[Y]*j + kOffset[Y]*k);
+    }
+
+    /** Position of tile (j, k) on the ground plane (X, Z) of the world,
+     * the layout players and the camera are placed with.
+     */
+    static VectorF2 TilePosition(int j, int k)
+    {
+        return jOffset * j + kOffset * k;
+    }
+
     void Create(int jSize, int kSize);
+    /** Only submit the tiles in \a range, clamped to the map. The entity
+     * path only touches tiles entering or leaving the range, the other
+     * paths cull whole rows or chunks. Returns the clamped range.
+     */
+    TileRange SetVisibleRange(TileRange range);
+    /** Emblems further than \a emblemDistance from the camera are dropped,
+     * borders further than \a borderDistance are painted by the tile
+     * shader instead of drawn on their own.
+     */
+    void SetLodDistances(real emblemDistance, real borderDistance)
+    {
+        myEmblemDistance = emblemDistance;
+        myBorderDistance = borderDistance;
+    }
+    /** Per-frame update for a camera at \a camera, in world coordinates:
+     * applies the level of detail.
+     */
+    void UpdateView(const VectorF4 &camera);
+    /** Program state switches the entity path's tiles and borders need
+     * in their current slot order.
+     */
+    uint GroundStateChanges() const
+    {
+        return 2 * myQueue.StateChanges();
+    }
+    int GetJLength()
+    {
+        return myJLength;
+    }
+    int GetKLength()
+    {
+        return myKLength;
+    }
     void SetTileType(int j, int k, char type);
     char GetTileType(int j, int k);
 };
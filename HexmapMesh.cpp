@@ -0,0 +1,124 @@
+#include "HexmapMesh.h"
+#include "core/Error.h"
+#include <cmath>
+#include <algorithm>
+
+HexmapMesh::HexmapMesh(const float *tile, uint tileFloats,
+        const float *border, uint borderFloats)
+    : myTileTemplate(tile), myBorderTemplate(border),
+    myTileVertices(tileFloats / TileFloats),
+    myBorderVertices(borderFloats / BorderFloats), myTypeStart(0),
+    myTileCount(0), myDirtyBegin(0), myDirtyEnd(0), myFullUpload(false),
+    myUploadCount(0), myUploadedBytes(0)
+{
+    for(int c = 0; c < 3; c++)
+        myMin[c] = myMax[c] = 0;
+    if(tileFloats % TileFloats != 0 || borderFloats % BorderFloats != 0)
+        throw Error(Error::InvalidValue, "Malformed hex tile template");
+}
+
+void HexmapMesh::Bake(const std::vector<VectorF2> &centers,
+        const std::vector<real> &rotations)
+{
+    if(centers.size() != rotations.size())
+        throw Error(Error::InvalidValue, "Need one rotation per tile");
+    myTileCount = centers.size();
+    myTypeStart = VertexCount() * VertexFloats;
+    myData.assign(myTypeStart + VertexCount(), 0.0f);
+
+    for(int c = 0; c < 3; c++)
+    {
+        myMin[c] = 1e30f;
+        myMax[c] = -1e30f;
+    }
+    float *out = myData.empty() ? NULL : &myData[0];
+    for(uint t = 0; t < myTileCount; t++)
+    {
+        float c = cos(rotations[t]);
+        float s = sin(rotations[t]);
+        for(uint v = 0; v < myTileVertices + myBorderVertices; v++)
+        {
+            const float *in;
+            if(v < myTileVertices)
+                in = &myTileTemplate[v * TileFloats];
+            else
+                in = &myBorderTemplate[(v - myTileVertices) * BorderFloats];
+            // Same as Translation(center) * RotationZ(rotation).
+            out[0] = c*in[0] - s*in[1] + centers[t][X]*in[3];
+            out[1] = s*in[0] + c*in[1] + centers[t][Y]*in[3];
+            out[2] = in[2];
+            out[3] = in[3];
+            out[4] = v < myTileVertices ? in[4] : -1.0f;
+            out[5] = v < myTileVertices ? in[5] : -1.0f;
+            for(int c = 0; c < 3; c++)
+            {
+                myMin[c] = std::min(myMin[c], out[c]);
+                myMax[c] = std::max(myMax[c], out[c]);
+            }
+            out += VertexFloats;
+        }
+    }
+    myFullUpload = true;
+    myDirtyBegin = myDirtyEnd = 0;
+}
+
+void HexmapMesh::SetType(uint tile, uint type)
+{
+    if(tile >= myTileCount)
+        throw Error(Error::InvalidValue, "Tile outside baked mesh");
+    uint count = TileVertexCount();
+    float *types = &myData[myTypeStart + tile * count];
+    if(types[0] == type)
+        return;
+    std::fill(types, types + count, float(type));
+    if(myDirtyBegin == myDirtyEnd)
+    {
+        myDirtyBegin = tile;
+        myDirtyEnd = tile + 1;
+    }
+    else
+    {
+        myDirtyBegin = std::min(myDirtyBegin, tile);
+        myDirtyEnd = std::max(myDirtyEnd, tile + 1);
+    }
+}
+
+void HexmapMesh::TypeRange(uint tile, size_t &offset, size_t &size) const
+{
+    size = TileVertexCount() * sizeof(float);
+    offset = TypeOffset() + tile * size;
+}
+
+bool HexmapMesh::TakeUpload(bool &full, size_t &offset, size_t &size,
+        const void *&data)
+{
+    if(myData.empty())
+        return false;
+    full = myFullUpload;
+    if(myFullUpload)
+    {
+        offset = 0;
+        size = Bytes();
+    }
+    else if(myDirtyBegin != myDirtyEnd)
+    {
+        size_t end, tileSize;
+        TypeRange(myDirtyBegin, offset, tileSize);
+        TypeRange(myDirtyEnd - 1, end, tileSize);
+        size = end + tileSize - offset;
+    }
+    else
+        return false;
+    data = reinterpret_cast<const char*>(&myData[0]) + offset;
+    myFullUpload = false;
+    myDirtyBegin = myDirtyEnd = 0;
+    myUploadCount++;
+    myUploadedBytes += size;
+    return true;
+}
+
+void HexmapMesh::MarkFullUpload()
+{
+    myFullUpload = true;
+    myDirtyBegin = myDirtyEnd = 0;
+}
@@ -0,0 +1,129 @@
+#ifndef HEXMAPMESH_H_
+#define HEXMAPMESH_H_
+
+#include <vector>
+#include <cstddef>
+#include "math/Vector.h"
+
+using namespace anengine;
+
+/** A block of hex tiles baked into one vertex array.
+ * Every tile contributes its ground triangles followed by its border
+ * triangles, both with the interleaved layout
+ *     Position float4, Texcoord float2
+ * Border vertices get the texcoord (-1, -1) so one program can draw both.
+ * After all interleaved vertices follows the Type block, one float per
+ * vertex, so the type of a tile is a contiguous range that can be patched
+ * on its own.
+ *
+ * The class holds no GL state: the bytes to upload are taken with
+ * TakeUpload and handed to the GL by the caller.
+ */
+class HexmapMesh
+{
+    public:
+    static const uint VertexFloats = 6;
+    static const uint TileFloats = 6;
+    static const uint BorderFloats = 4;
+    static const uint VertexStride = VertexFloats * sizeof(float);
+
+    private:
+    const float *myTileTemplate;
+    const float *myBorderTemplate;
+    uint myTileVertices;
+    uint myBorderVertices;
+    std::vector<float> myData;
+    uint myTypeStart;
+    uint myTileCount;
+    float myMin[3];
+    float myMax[3];
+    uint myDirtyBegin;
+    uint myDirtyEnd;
+    bool myFullUpload;
+    uint myUploadCount;
+    size_t myUploadedBytes;
+
+    public:
+    /** The \a tileFloats floats at \a tile hold the template tile as
+     * Position float4, Texcoord float2 and the \a borderFloats at \a border
+     * the template border as Position float4. They are read in place, from
+     * a mapped VertexFile say, and must outlive the mesh.
+     */
+    HexmapMesh(const float *tile, uint tileFloats, const float *border,
+            uint borderFloats);
+    ~HexmapMesh() { }
+
+    /** Bake one tile per entry of \a centers, rotated around its center by
+     * the matching entry of \a rotations. All types start at 0.
+     */
+    void Bake(const std::vector<VectorF2> &centers,
+            const std::vector<real> &rotations);
+
+    /** Set the type of tile \a tile, marking its Type range for upload if
+     * it changed.
+     */
+    void SetType(uint tile, uint type);
+
+    uint TileCount() const
+    {
+        return myTileCount;
+    }
+    uint TileVertexCount() const
+    {
+        return myTileVertices + myBorderVertices;
+    }
+    uint VertexCount() const
+    {
+        return myTileCount * TileVertexCount();
+    }
+    size_t TypeOffset() const
+    {
+        return myTypeStart * sizeof(float);
+    }
+    size_t Bytes() const
+    {
+        return myData.size() * sizeof(float);
+    }
+    /** Bounding box of the baked vertices.
+     */
+    const float *Min() const
+    {
+        return myMin;
+    }
+    const float *Max() const
+    {
+        return myMax;
+    }
+    /** Whether TakeUpload has anything to upload.
+     */
+    bool Dirty() const
+    {
+        return myFullUpload || myDirtyBegin != myDirtyEnd;
+    }
+    /** Byte range of the Type attribute of \a tile.
+     */
+    void TypeRange(uint tile, size_t &offset, size_t &size) const;
+
+    /** Take what needs to be uploaded since the last call. Returns false
+     * if nothing changed. After a bake \a full is set and the range is the
+     * whole buffer, otherwise it is the single range covering every tile
+     * patched since, so each frame needs at most one buffer update.
+     */
+    bool TakeUpload(bool &full, size_t &offset, size_t &size, const void *&data);
+
+    /** Have the next TakeUpload hand out the whole buffer again, for when
+     * the buffer it went to was deleted.
+     */
+    void MarkFullUpload();
+
+    uint UploadCount() const
+    {
+        return myUploadCount;
+    }
+    size_t UploadedBytes() const
+    {
+        return myUploadedBytes;
+    }
+};
+
+#endif
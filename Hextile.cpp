@@ -1,5 +1,6 @@
 #include "Hextile.h"
+#include "AssetBundle.h"
 #include "assets/AssetManager.h"
 
-StaticAsset<VertexBuffer> Hextile::myVertexBuffer(AssetManager
-            ::CreateStaticFromFile<VertexBuffer>("assets/geometry/hextile.gen.vbo"));
+StaticAsset<VertexBuffer> Hextile::myVertexBuffer(AssetBundle
+            ::Static<VertexBuffer>("assets/geometry/hextile.gen.vbo"));
@@ -3,6 +3,7 @@
 
 #include "entity/FixedGeometry.h"
 #include "assets/AssetManager.h"
+#include "RenderStats.h"
 
 using namespace anengine;
 
@@ -16,7 +17,7 @@ class Hextile : public FixedGeometry
     }
     virtual void OnDraw(FrameTime elapsed)
     {
-        glDrawArrays(GL_TRIANGLES, 0, 48);
+        RenderStats::DrawArrays(GL_TRIANGLES, 0, 48);
     }
     public:
     virtual ~Hextile() { }
@@ -93,7 +93,7 @@ void Laser::OnNewProgram()
 void Laser::OnDraw(FrameTime elapsed)
 {
     //glPolygonMode( GL_FRONT_AND_BACK, GL_LINE );
-    glDrawArrays(GL_TRIANGLES, 0, 6);
+    RenderStats::DrawArrays(GL_TRIANGLES, 0, 6);
 }
 
 void LaserAnimationData::Update(real t)
@@ -7,6 +7,7 @@
 #include "assets/Shader.h"
 #include "entity/SceneGraph.h"
 #include "util/AnimationHelper.h"
+#include "RenderStats.h"
 
 using namespace anengine;
 
@@ -1,6 +1,7 @@
 
 
 #include <iostream>
+#include <cstdio>
 #include "backend/sdl/SDLEventSource.h"
 #include "backend/sdl/SDLContext.h"
 #include "event/EventPrinter.h"
@@ -24,29 +25,224 @@
 #include "NetworkService.h"
 #include "GameStateService.h"
 #include "SoundManager.h"
+#include "NullContext.h"
+#include "Profiler.h"
+#include "AssetBundle.h"
+#include "TextureLoader.h"
+#include "SdfFont.h"
+#include "TextCache.h"
+#include "TextRasterizer.h"
 
 using namespace anengine;
+
+struct StartupAssets
+{
+    AssetRef<Keymap> NavigationKeymap;
+    AssetRef<Program> SkyShader;
+    AssetRef<Program> PlayerShader;
+    AssetRef<Texture> GroundTex;
+    AssetRef<Texture> EmblemTex;
+    AssetRef<Texture> FigureTex;
+    AssetRef<Texture> LaserTex;
+    AssetRef<Texture> MortarTex;
+    AssetRef<Texture> DroidTex;
+    AssetRef<Texture> SkyTex;
+    AssetRef<Texture> ExplosionTex;
+    AssetRef<Texture> IconTex;
+};
+
+static void LoadAssets(AssetManager *manager, TextureLoader &textures,
+        StartupAssets &assets)
+{
+    assets.NavigationKeymap = AssetBundle::Load<Keymap>(manager, "assets/Navigation.kmp");
+    assets.SkyShader = AssetBundle::Load<Program>(manager, "assets/shaders/Sky.sp");
+    assets.PlayerShader = AssetBundle::Load<Program>(manager, "assets/shaders/Player.sp");
+    assets.GroundTex = textures.Load(manager, "assets/textures/tiles.gen.png");
+    assets.EmblemTex = textures.Load(manager, "assets/textures/emblems.gen.png");
+    assets.FigureTex = textures.Load(manager, "assets/textures/figure.gen.png");
+    assets.LaserTex = textures.Load(manager, "assets/textures/laser.gen.png");
+    assets.MortarTex = textures.Load(manager, "assets/textures/mortar.gen.png");
+    assets.DroidTex = textures.Load(manager, "assets/textures/droid.gen.png");
+    assets.SkyTex = textures.Load(manager, "assets/textures/sky.gen.png");
+    assets.ExplosionTex = textures.Load(manager, "assets/textures/explosion.gen.png");
+    assets.IconTex = textures.Load(manager, "assets/textures/icons.gen.png");
+}
+
+/** Runs the viewer without a display.
+ * The scene graph only serves as asset manager: it is never scheduled and
+ * never gets a root, so no entity is created and no GL call is made. The
+ * network, game state and animation update path runs exactly as it does
+ * with a window.
+ *
+ * With a \a replay log the match is read from the log instead, frames are
+ * not paced, every animation completes in one frame and the benchmark
+ * report is printed once the log is exhausted.
+ *
+ * With \a sound the sounds are played too, meant for the offline sndlib
+ * backends.
+ */
+static int RunHeadless(std::string host, std::string port,
+        std::string record, std::string replay, bool sound)
+{
+    bool benchmark = replay.size() != 0;
+    Dispatcher dispatcher;
+    NullContext context(benchmark ? 0 : 60);
+    SceneGraph scene;
+    // Never initialized, nothing is drawn.
+    TextureLoader textures;
+    StartupAssets assets;
+    LoadAssets(scene.GetAssetManager(), textures, assets);
+
+    NetworkService ns(host, port);
+    if(record.size() != 0)
+        ns.SetRecordFile(record);
+    if(benchmark)
+        ns.SetReplayFile(replay);
+    dispatcher.AddService(ns);
+    dispatcher.AddService(context);
+    Pin::Connect(context, "Misc", dispatcher, "Quit");
+    Pin::Connect(ns, "Quit", dispatcher, "Quit");
+
+    MultiContainer c;
+    Hexmap map(assets.GroundTex, assets.EmblemTex);
+    c.AddChild(&map);
+
+    Camera cam;
+    GameStateService gamestate(&c, &map, assets.PlayerShader, assets.FigureTex,
+            assets.LaserTex, assets.MortarTex, assets.DroidTex,
+            assets.ExplosionTex, assets.IconTex, &cam);
+    gamestate.SetTurbo(benchmark);
+    dispatcher.AddService(gamestate);
+
+    gamestate.DependOn(&context);
+    ns.DependOn(&gamestate);
+
+    Pin::Connect(ns, "GameStates", gamestate, "StateUpdates");
+    Pin::Connect(gamestate, "Done", ns, "Done");
+
+    SoundManager soundManager;
+    if(sound)
+    {
+        dispatcher.AddService(soundManager);
+        Pin::Connect(gamestate, "Sound", soundManager, "Sound");
+    }
+
+    if(benchmark)
+        Profiler::Start();
+    dispatcher.Run();
+    TextRasterizer::Stop();
+    if(benchmark)
+    {
+        Profiler::Stop();
+        Profiler::Print();
+    }
+
+    Debug("Bye!");
+    return 0;
+}
+
+static bool ParseRenderPath(std::string name, Hexmap::RenderPath &path)
+{
+    if(name == "entities")
+        path = Hexmap::Entities;
+    else if(name == "instanced")
+        path = Hexmap::Instanced;
+    else if(name == "baked")
+        path = Hexmap::Baked;
+    else if(name == "chunked")
+        path = Hexmap::Chunked;
+    else
+        return false;
+    return true;
+}
+
+static void PrintUsage(const char *name)
+{
+    cerr<<"Usage: "<<name<<" {-f|-n} {-t} {-m <path>} {-l <lod>} {-r <log>} {-s <file>|-w <wav>} <hostname> <port>"<<endl;
+    cerr<<"       "<<name<<" {-s <file>|-w <wav>} -b <log>"<<endl;
+    cerr<<"  -f        fullscreen"<<endl;
+    cerr<<"  -n        headless, no window or GL"<<endl;
+    cerr<<"  -t        draw titles with the distance field font"<<endl;
+    cerr<<"  -m <path> map rendering: entities (default), instanced,"<<endl;
+    cerr<<"            baked or chunked"<<endl;
+    cerr<<"  -l <emblems>,<borders>"<<endl;
+    cerr<<"            distances beyond which tile emblems are dropped and"<<endl;
+    cerr<<"            borders are drawn by the tiles"<<endl;
+    cerr<<"  -r <log>  record the match to <log>"<<endl;
+    cerr<<"  -b <log>  benchmark: replay <log> headless at maximum speed"<<endl;
+    cerr<<"  -s <file> no audio device, write the sounds played to <file>"<<endl;
+    cerr<<"  -w <wav>  no audio device, mix the sounds played into <wav>"<<endl;
+}
+
 int main(int argc, const char *argv[])
 {
     std::string host;
     std::string port;
+    std::string record;
+    std::string replay;
+    std::string soundFile;
+    int soundBackend = SNDLIB_BACKEND_MIXER;
     bool fullscreen = false;
-    if(argc == 3 && argv[1][0] != '-')
+    bool headless = false;
+    Hexmap::RenderPath mapPath = Hexmap::Entities;
+    float emblemDistance = Hexmap::DefaultEmblemDistance;
+    float borderDistance = Hexmap::DefaultBorderDistance;
+    int arg = 1;
+    for(; arg < argc && argv[arg][0] == '-'; arg++)
     {
-        host = argv[1];
-        port = argv[2];
+        if(argv[arg][1] == 'f')
+            fullscreen = true;
+        else if(argv[arg][1] == 'n')
+            headless = true;
+        else if(argv[arg][1] == 't')
+            Textbox::UseSdf = true;
+        else if(argv[arg][1] == 'r' && arg + 1 < argc)
+            record = argv[++arg];
+        else if(argv[arg][1] == 'b' && arg + 1 < argc)
+            replay = argv[++arg];
+        else if(argv[arg][1] == 's' && arg + 1 < argc)
+        {
+            soundBackend = SNDLIB_BACKEND_NULL;
+            soundFile = argv[++arg];
+        }
+        else if(argv[arg][1] == 'w' && arg + 1 < argc)
+        {
+            soundBackend = SNDLIB_BACKEND_WAV;
+            soundFile = argv[++arg];
+        }
+        else if(argv[arg][1] == 'm' && arg + 1 < argc &&
+                ParseRenderPath(argv[arg + 1], mapPath))
+            arg++;
+        else if(argv[arg][1] == 'l' && arg + 1 < argc &&
+                sscanf(argv[arg + 1], "%f,%f", &emblemDistance, &borderDistance) == 2)
+            arg++;
+        else
+        {
+            PrintUsage(argv[0]);
+            return 1;
+        }
     }
-    else if(argc == 4 && argv[1][0] == '-' && argv[1][1] == 'f')
+    sndlib_set_backend(soundBackend, soundFile.c_str());
+    bool offlineSound = soundBackend != SNDLIB_BACKEND_MIXER;
+    if(replay.size() != 0)
     {
-        host = argv[2];
-        port = argv[3];
-        fullscreen = true;
+        if(arg != argc)
+        {
+            PrintUsage(argv[0]);
+            return 1;
+        }
+        return RunHeadless(host, port, record, replay, offlineSound);
     }
-    else 
+    if(argc - arg != 2)
     {
-        cerr<<"Usage: "<<argv[0]<<" {-f} <hostname> <port>"<<endl;
+        PrintUsage(argv[0]);
         return 1;
     }
+    host = argv[arg];
+    port = argv[arg + 1];
+
+    if(headless)
+        return RunHeadless(host, port, record, replay, offlineSound);
 
     Dispatcher dispatcher;
     SDLEventSource source;
@@ -57,34 +253,21 @@ int main(int argc, const char *argv[])
     KeymapFilter keymapFilter;
 
     NetworkService ns(host, port);
+    if(record.size() != 0)
+        ns.SetRecordFile(record);
     dispatcher.AddService(ns);
 
-    AssetRef<Keymap> keymap = scene.GetAssetManager()
-        ->CreateFromFile<Keymap>("assets/Navigation.kmp");
-    AssetRef<Program> skyShader = scene.GetAssetManager()
-        ->CreateFromFile<Program>("assets/shaders/Sky.sp");
-    AssetRef<Program> playerShader = scene.GetAssetManager()
-        ->CreateFromFile<Program>("assets/shaders/Player.sp");
-    AssetRef<Texture> groundTex = scene.GetAssetManager()
-        ->CreateFromFile<Texture>("assets/textures/tiles.gen.png");
-    AssetRef<Texture> emblemTex = scene.GetAssetManager()
-        ->CreateFromFile<Texture>("assets/textures/emblems.gen.png");
-    AssetRef<Texture> figureTex = scene.GetAssetManager()
-        ->CreateFromFile<Texture>("assets/textures/figure.gen.png");
-    AssetRef<Texture> laserTex = scene.GetAssetManager()
-        ->CreateFromFile<Texture>("assets/textures/laser.gen.png");
-    AssetRef<Texture> mortarTex = scene.GetAssetManager()
-        ->CreateFromFile<Texture>("assets/textures/mortar.gen.png");
-    AssetRef<Texture> droidTex = scene.GetAssetManager()
-        ->CreateFromFile<Texture>("assets/textures/droid.gen.png");
-    AssetRef<Texture> skyTex = scene.GetAssetManager()
-        ->CreateFromFile<Texture>("assets/textures/sky.gen.png");
-    AssetRef<Texture> explosionTex = scene.GetAssetManager()
-        ->CreateFromFile<Texture>("assets/textures/explosion.gen.png");
-    AssetRef<Texture> iconTex = scene.GetAssetManager()
-        ->CreateFromFile<Texture>("assets/textures/icons.gen.png");
-
-    keymapFilter.SetKeymap(keymap);
+    double loadStart = Profiler::Now();
+    TextureLoader textures;
+    StartupAssets assets;
+    LoadAssets(scene.GetAssetManager(), textures, assets);
+    textures.Start();
+    // Titles wait for the distance field atlas, build it meanwhile.
+    if(Textbox::UseSdf)
+        SdfFont::Request();
+    double setupStart = Profiler::Now();
+
+    keymapFilter.SetKeymap(assets.NavigationKeymap);
     hub.CreateInPin("In");
     hub.CreateInPin("GFXIn");
     hub.CreateOutPin("Context");
@@ -105,30 +288,35 @@ int main(int argc, const char *argv[])
     Pin::Connect(hub, "Scene", scene, "Misc");
 
     context.DependOn(&source);
+    textures.DependOn(&context);
     scene.DependOn(&context);
+    scene.DependOn(&textures);
     scene.DependOn(&keymapFilter);
 
     dispatcher.AddService(context);
     dispatcher.AddService(source);
+    dispatcher.AddService(textures);
     dispatcher.AddService(scene);
 
     MultiContainer c;
 
 
-    Skybox sky(skyTex);
-    sky.SetProgram(skyShader);
+    Skybox sky(assets.SkyTex);
+    sky.SetProgram(assets.SkyShader);
     c.AddChild(&sky);
 
     Movable mapMov;
     mapMov.Transform.Set(MatrixF4::RotationX(3*Pi/2)*MatrixF4::RotationZ(Pi));
-    Hexmap map(groundTex, emblemTex);
+    Hexmap map(assets.GroundTex, assets.EmblemTex, mapPath);
+    map.SetLodDistances(emblemDistance, borderDistance);
     mapMov.SetChild(&map);
     c.AddChild(&mapMov);
 
     Camera cam;
     scene.GetCameraManager().SetCamera(&cam);
-    GameStateService gamestate(&c, &map, playerShader, figureTex, laserTex, 
-            mortarTex, droidTex, explosionTex, iconTex, &cam);
+    GameStateService gamestate(&c, &map, assets.PlayerShader, assets.FigureTex,
+            assets.LaserTex, assets.MortarTex, assets.DroidTex,
+            assets.ExplosionTex, assets.IconTex, &cam);
     dispatcher.AddService(gamestate);
 
     gamestate.DependOn(&scene);
@@ -143,8 +331,14 @@ int main(int argc, const char *argv[])
 
     scene.SetRoot(&c);
 
+    // The textures are decoded meanwhile, their own timings come when
+    // they are uploaded.
+    Debug("Startup: assets queued in %.1f ms, scene set up in %.1f ms",
+            (setupStart - loadStart) * 1000, (Profiler::Now() - setupStart) * 1000);
     dispatcher.Run();
+    TextRasterizer::Stop();
 
+    TextCache::Print();
     Debug("Bye!");
     return 0;
 }
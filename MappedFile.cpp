@@ -0,0 +1,44 @@
+#include "MappedFile.h"
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+MappedFile::MappedFile(const char *path)
+    : myMap(MAP_FAILED), myData(NULL), mySize(0)
+{
+    int fd = open(path, O_RDONLY);
+    if(fd == -1)
+        return;
+    struct stat st;
+    if(fstat(fd, &st) == 0 && st.st_size > 0)
+    {
+        myMap = mmap(NULL, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+        if(myMap != MAP_FAILED)
+        {
+            myData = static_cast<const unsigned char*>(myMap);
+            mySize = st.st_size;
+        }
+    }
+    close(fd);
+}
+
+MappedFile::MappedFile(const void *bytes, size_t size)
+    : myMap(MAP_FAILED), myData(static_cast<const unsigned char*>(bytes)),
+    mySize(size)
+{
+}
+
+MappedFile::~MappedFile()
+{
+    Close();
+}
+
+void MappedFile::Close()
+{
+    if(myMap != MAP_FAILED)
+        munmap(myMap, mySize);
+    myMap = MAP_FAILED;
+    myData = NULL;
+    mySize = 0;
+}
@@ -0,0 +1,57 @@
+#ifndef MAPPEDFILE_H_
+#define MAPPEDFILE_H_
+
+#include <cstddef>
+#include <stdint.h>
+#include "core/Debug.h"
+
+using namespace anengine;
+
+/** Read only bytes of a packed asset: a whole file mapped and shared with
+ * the page cache, or bytes borrowed from elsewhere, like the asset bundle.
+ * The packed formats the assets build writes are read with ReadU32.
+ */
+class MappedFile
+{
+    void *myMap;
+    const unsigned char *myData;
+    size_t mySize;
+
+    MappedFile(const MappedFile &);
+    MappedFile &operator=(const MappedFile &);
+
+    public:
+    /** Maps \a path. Empty if it cannot be opened or mapped.
+     */
+    MappedFile(const char *path);
+    /** The \a size bytes at \a bytes, which must stay valid.
+     */
+    MappedFile(const void *bytes, size_t size);
+    ~MappedFile();
+
+    /** Unmaps the file, leaving it empty.
+     */
+    void Close();
+
+    bool Empty() const
+    {
+        return myData == NULL;
+    }
+    const unsigned char *Data() const
+    {
+        return myData;
+    }
+    size_t Size() const
+    {
+        return mySize;
+    }
+
+    /** The little endian 32-bit integer at \a bytes.
+     */
+    static uint32_t ReadU32(const unsigned char *bytes)
+    {
+        return bytes[0] | bytes[1] << 8 | bytes[2] << 16 | (uint32_t)bytes[3] << 24;
+    }
+};
+
+#endif
@@ -1,52 +1,94 @@
 
 #include "Nametag.h"
+#include "AssetBundle.h"
 #include "textlib/textlib.h"
+#include "TextRasterizer.h"
 
 namespace anengine
 {
     PropertyInfo Nametag::PlayerNameProperty("PlayerName", typeid(Nametag));
     PropertyInfo Nametag::HealthProperty("Health", typeid(Nametag));
+    StaticAsset<Program> Nametag::NametagProgram(AssetBundle
+            ::Static<Program>("assets/shaders/Nametag.sp"));
+    NametagAtlas Nametag::Atlas;
 
     void Nametag::OnPropertyChanged(const PropertyInfo *id, bool implicit)
     {
-        if(id == &PlayerNameProperty || id == &HealthProperty)
+        if(id == &PlayerNameProperty)
         {
             if(IsCreated())
-                UpdateStatus();
+                UpdateName();
         }
-        Billboard::OnPropertyChanged(id, implicit);
+        else if(id == &HealthProperty)
+        {
+            if(HasProgram())
+                ProgramState().SetUniform("Health", Health.Get());
+        }
+        CulledBillboard::OnPropertyChanged(id, implicit);
     }
 
     void Nametag::OnCreate()
     {
-        myTexture = Scene.Get()->GetAssetManager()->CreateFromMemory<Texture>("");
-        UpdateStatus();
-        SetTexture(myTexture);
-        Billboard::OnCreate();
+        // Every tag has its own health, so each needs its own state.
+        if(!HasProgram())
+        {
+            AssetRef<Program> program = NametagProgram.Get(Scene.Get()->GetAssetManager());
+            SetProgram(program, program->CreateState());
+        }
+        mySlot = Atlas.Allocate();
+        ProgramState().SetUniform("FrameCount", NametagAtlas::FrameCount());
+        ProgramState().SetUniform("Frame", NametagAtlas::Frame(mySlot));
+        UpdateName();
+        CulledBillboard::OnCreate();
     }
 
     void Nametag::OnDestroy()
     {
-        myTexture.Release();
-        Billboard::OnDestroy();
+        TextRasterizer::Cancel(myTicket);
+        myTicket = 0;
+        CulledBillboard::OnDestroy();
+        Atlas.Free(mySlot);
+        mySlot = -1;
     }
 
     void Nametag::OnNewProgram()
     {
         ProgramState().SetUniform("Flip", VectorF2(0,1));
-        Billboard::OnNewProgram();
+        ProgramState().SetUniform("Health", Health.Get());
+        if(mySlot >= 0)
+        {
+            ProgramState().SetUniform("FrameCount", NametagAtlas::FrameCount());
+            ProgramState().SetUniform("Frame", NametagAtlas::Frame(mySlot));
+        }
+        CulledBillboard::OnNewProgram();
+    }
+
+    void Nametag::OnDraw(FrameTime elapsed)
+    {
+        if(Culled)
+            return;
+        SDL_Surface *name = NULL;
+        if(myTicket != 0 && TextRasterizer::Take(myTicket, name))
+        {
+            myTicket = 0;
+            if(name != NULL)
+            {
+                Atlas.SetSlot(mySlot, name);
+                SDL_FreeSurface(name);
+            }
+        }
+        Atlas.Upload();
+        Atlas.Bind();
+        CulledBillboard::OnDraw(elapsed);
+        Atlas.Unbind();
     }
 
-    void Nametag::UpdateStatus()
+    void Nametag::UpdateName()
     {
-        SDL_Surface *stat = textlib_get_nametag(PlayerName.Get().c_str(), Health.Get());
-        TextureSettings settings;
-        settings.MinFilter = GL_LINEAR_MIPMAP_LINEAR;
-        settings.MagFilter = GL_LINEAR;
-        settings.GenerateMipmap = true;
-        SDL_LockSurface(stat);
-        myTexture->SetData(stat->w, stat->h, GL_BGRA, stat->pixels, settings);
-        SDL_UnlockSurface(stat);
-        SDL_FreeSurface(stat);
+        TextRasterizer::Cancel(myTicket);
+        std::string name = PlayerName.Get();
+        myTicket = TextRasterizer::Request([name]() {
+                return textlib_get_nametag_name(name.c_str());
+            });
     }
 };
@@ -1,19 +1,28 @@
 #ifndef NAMETAG_H_
 #define NAMETAG_H_
 
-#include "entity/Billboard.h"
+#include "CulledBillboard.h"
+#include "NametagAtlas.h"
 
 namespace anengine
 {
-    class Nametag : public Billboard
+    /** Player name over a health bar. The name is rendered once, on the
+     * text rasterizer, into a slot of the shared nametag atlas; the bar
+     * is drawn by the nametag program from the Health uniform.
+     */
+    class Nametag : public CulledBillboard
     {
-        Asset<Texture> myTexture;
-        void UpdateStatus();
+        static StaticAsset<Program> NametagProgram;
+        static NametagAtlas Atlas;
+        int mySlot;
+        uint myTicket;
+        void UpdateName();
         protected:
         virtual void OnPropertyChanged(const PropertyInfo *id, bool implicit);
         virtual void OnCreate();
         virtual void OnDestroy();
         virtual void OnNewProgram();
+        virtual void OnDraw(FrameTime elapsed);
         public:
         static PropertyInfo PlayerNameProperty;
         Property<std::string> PlayerName;
@@ -21,7 +30,7 @@ namespace anengine
         Property<real> Health;
 
         Nametag() 
-            : Billboard(),
+            : CulledBillboard(), mySlot(-1), myTicket(0),
             PlayerName(&PlayerNameProperty, this),
             Health(&HealthProperty, this)
         { }
@@ -0,0 +1,127 @@
+#include "NametagAtlas.h"
+#include "core/Error.h"
+#include <cstring>
+#include <algorithm>
+
+int NametagAtlas::Allocate()
+{
+    if(myUsedSlots == 0)
+    {
+        myPixels.assign(Columns * SlotWidth * Rows * SlotHeight, 0);
+        myFreeSlots.clear();
+        for(int i = Columns * Rows - 1; i >= 0; i--)
+            myFreeSlots.push_back(i);
+        myDirtyRows.assign(Rows, false);
+        myFullUpload = true;
+    }
+    if(myFreeSlots.empty())
+        throw Error(Error::InvalidValue, "Nametag atlas is full");
+    int slot = myFreeSlots.back();
+    myFreeSlots.pop_back();
+    myUsedSlots++;
+    return slot;
+}
+
+void NametagAtlas::Free(int slot)
+{
+    if(slot < 0)
+        return;
+    myFreeSlots.push_back(slot);
+    myUsedSlots--;
+    if(myUsedSlots == 0)
+    {
+        if(myTexture != 0)
+            glDeleteTextures(1, &myTexture);
+        myTexture = 0;
+        myPixels.clear();
+        myFullUpload = false;
+    }
+}
+
+void NametagAtlas::SetSlot(int slot, SDL_Surface *surface)
+{
+    if(surface->w != SlotWidth || surface->h != SlotHeight ||
+            surface->format->BytesPerPixel != 4)
+    {
+        Debug("Nametag surface is %dx%d, %d bytes per pixel", surface->w,
+                surface->h, surface->format->BytesPerPixel);
+        throw Error(Error::InvalidValue, "Nametag surface does not fit the atlas");
+    }
+    int stride = Columns * SlotWidth;
+    Uint32 *dest = &myPixels[(slot / Columns) * SlotHeight * stride +
+        (slot % Columns) * SlotWidth];
+    SDL_LockSurface(surface);
+    for(int y = 0; y < SlotHeight; y++)
+    {
+        memcpy(dest + y * stride, (Uint8*)surface->pixels + y * surface->pitch,
+                SlotWidth * sizeof(Uint32));
+    }
+    SDL_UnlockSurface(surface);
+    myDirtyRows[slot / Columns] = true;
+}
+
+void NametagAtlas::Upload()
+{
+    if(!myFullUpload && std::find(myDirtyRows.begin(), myDirtyRows.end(),
+                true) == myDirtyRows.end())
+        return;
+    GLint bound;
+    glGetIntegerv(GL_TEXTURE_BINDING_2D, &bound);
+    int width = Columns * SlotWidth;
+    if(myTexture == 0)
+    {
+        glGenTextures(1, &myTexture);
+        glBindTexture(GL_TEXTURE_2D, myTexture);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    }
+    else
+        glBindTexture(GL_TEXTURE_2D, myTexture);
+
+    if(myFullUpload)
+    {
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, width, Rows * SlotHeight, 0,
+                GL_BGRA, GL_UNSIGNED_BYTE, &myPixels[0]);
+        myDirtyRows.assign(Rows, false);
+        myFullUpload = false;
+    }
+    for(int row = 0; row < Rows; row++)
+    {
+        if(!myDirtyRows[row])
+            continue;
+        // Neighbouring dirty rows go in one update.
+        int end = row;
+        while(end < Rows && myDirtyRows[end])
+            myDirtyRows[end++] = false;
+        glTexSubImage2D(GL_TEXTURE_2D, 0, 0, row * SlotHeight, width,
+                (end - row) * SlotHeight, GL_BGRA, GL_UNSIGNED_BYTE,
+                &myPixels[row * SlotHeight * width]);
+        row = end;
+    }
+    glBindTexture(GL_TEXTURE_2D, bound);
+}
+
+void NametagAtlas::Bind()
+{
+    GLint program = 0;
+    glGetIntegerv(GL_CURRENT_PROGRAM, &program);
+    if(program != myProgramId)
+    {
+        myProgramId = program;
+        mySampler = glGetUniformLocation(program, "Texture");
+    }
+    glGetIntegerv(GL_ACTIVE_TEXTURE, &myBoundUnit);
+    glActiveTexture(GL_TEXTURE0);
+    glGetIntegerv(GL_TEXTURE_BINDING_2D, &myBoundTexture);
+    glBindTexture(GL_TEXTURE_2D, myTexture);
+    if(mySampler != -1)
+        glUniform1i(mySampler, 0);
+}
+
+void NametagAtlas::Unbind()
+{
+    glBindTexture(GL_TEXTURE_2D, myBoundTexture);
+    glActiveTexture(myBoundUnit);
+}
@@ -0,0 +1,80 @@
+#ifndef NAMETAGATLAS_H_
+#define NAMETAGATLAS_H_
+
+#include <vector>
+#include <GL/glew.h>
+#include <SDL.h>
+#include "math/Vector.h"
+
+using namespace anengine;
+
+/** One texture holding the names of all nametags.
+ * The texture is split into fixed SlotWidth x SlotHeight slots, one per
+ * nametag, laid out as a grid of Columns x Rows frames so a tag selects
+ * its slot with the Frame and FrameCount uniforms. Changed slots are copied
+ * into a CPU image, and the rows of the grid holding them are uploaded at
+ * most once a frame, right before the first nametag draws. The texture
+ * has no mipmaps: the slots have no border, so smaller levels would blend
+ * neighbouring tags together.
+ *
+ * The atlas owns its GL texture, since the engine's Texture can only be
+ * replaced as a whole; nametags bind it around their draw with Bind and
+ * Unbind.
+ */
+class NametagAtlas
+{
+    public:
+    static const int SlotWidth = 256;
+    static const int SlotHeight = 32;
+    static const int Columns = 4;
+    static const int Rows = 32;
+
+    private:
+    GLuint myTexture;
+    GLint myProgramId;
+    GLint mySampler;
+    GLint myBoundUnit;
+    GLint myBoundTexture;
+    std::vector<Uint32> myPixels;
+    std::vector<int> myFreeSlots;
+    std::vector<bool> myDirtyRows;
+    uint myUsedSlots;
+    bool myFullUpload;
+
+    public:
+    NametagAtlas()
+        : myTexture(0), myProgramId(0), mySampler(-1), myBoundUnit(0),
+        myBoundTexture(0), myUsedSlots(0), myFullUpload(false) { }
+    ~NametagAtlas() { }
+
+    /** Reserves a slot, clearing the image with the first one.
+     */
+    int Allocate();
+    /** Returns a slot, deleting the texture with the last one.
+     */
+    void Free(int slot);
+    /** Copies a SlotWidth x SlotHeight 32-bit surface into \a slot.
+     */
+    void SetSlot(int slot, SDL_Surface *surface);
+    /** Creates the texture on the first call, then uploads the changed
+     * rows.
+     */
+    void Upload();
+    /** Binds the texture to unit 0 and points the Texture sampler of the
+     * current program at it.
+     */
+    void Bind();
+    /** Rebinds what Bind replaced.
+     */
+    void Unbind();
+    static VectorI2 Frame(int slot)
+    {
+        return VectorI2(slot % Columns, slot / Columns);
+    }
+    static VectorI2 FrameCount()
+    {
+        return VectorI2(Columns, Rows);
+    }
+};
+
+#endif
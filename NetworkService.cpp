@@ -1,11 +1,14 @@
 #include "NetworkService.h"
 #include <unistd.h>
 #include <signal.h>
+#include "Profiler.h"
 
 void NetworkService::OnUpdate(FrameTime time)
 {
+    Profiler::Scope scope(Profiler::Handoff);
     pthread_mutex_lock(&myGameSateLock);
     bool newGameState(myNewGameState);
+    bool finished(myFinished);
     GameState gameState;
     if(myNewGameState)
         gameState = myGameState;
@@ -14,9 +17,17 @@ void NetworkService::OnUpdate(FrameTime time)
     pthread_mutex_unlock(&myGameSateLock);
     if(newGameState)
     {
+        Profiler::Count(Profiler::States);
         GameStateEvent event(GameStateEventCodes::NewGameState, this, gameState);
         myGameStatePin.Send(event);
     }
+    else if(finished && !myQuitSent)
+    {
+        Debug("Replay finished");
+        Event quit(EventClass::Misc, MiscEventCodes::Quit, this);
+        myQuitPin.Send(quit);
+        myQuitSent = true;
+    }
 }
 
 void NetworkService::OnInitialize()
@@ -61,9 +72,14 @@ void *NetworkService::sNetworkMain(void *arg)
 void *NetworkService::NetworkMain()
 {
     GameState gameState;
-    if(myHost.size() == 0)
+    if(myReplayFile.size() != 0)
+        myTransport.Replay(myReplayFile);
+    else if(myHost.size() == 0)
         return NULL;
-    myTransport.Connect(myHost, myPort);
+    else
+        myTransport.Connect(myHost, myPort);
+    if(myRecordFile.size() != 0)
+        myTransport.Record(myRecordFile);
     myProtocol.Initialize();
     pthread_mutex_lock(&myGameSateLock);
     while(!myQuit)
@@ -96,8 +112,14 @@ void *NetworkService::NetworkMain()
                     pthread_cond_wait(&myDoneCond, &myGameSateLock);
                     Debug("N: Got done");
                 }
-                if(!myQuit)
-                    myProtocol.NotifyDone();
+                if(myQuit)
+                    break;
+                if(myTransport.AtEnd())
+                {
+                    myFinished = true;
+                    break;
+                }
+                myProtocol.NotifyDone();
             }
         }
     };
@@ -17,14 +17,19 @@ class NetworkService : public Service
     bool myNewGameState;
     bool myQuit;
     bool myDone;
+    bool myFinished;
 
     // Game-side values
     GameState myGameState;
     OutPin myGameStatePin;
+    OutPin myQuitPin;
+    bool myQuitSent;
 
     // Network-side values
     std::string myHost;
     std::string myPort;
+    std::string myReplayFile;
+    std::string myRecordFile;
     NetworkTransport myTransport;
     ProtocolHandler myProtocol;
 
@@ -34,10 +39,11 @@ class NetworkService : public Service
     bool DoneUpdate(Event &event, InPin pin);
     public:
     NetworkService(std::string host, std::string port)
-        : myNewGameState(false), myQuit(false), myDone(false), myHost(host), 
-        myPort(port), myProtocol(&myTransport)
+        : myNewGameState(false), myQuit(false), myDone(false), myFinished(false),
+        myQuitSent(false), myHost(host), myPort(port), myProtocol(&myTransport)
     {
         myGameStatePin = RegisterOutPin(SkyportEventClass::GameState, "GameStates");
+        myQuitPin = RegisterOutPin(EventClass::Misc, "Quit");
 
         RegisterInPin(SkyportEventClass::GameState, "Done", 
                 static_cast<EventCallback>(&NetworkService::DoneUpdate));
@@ -54,6 +60,22 @@ class NetworkService : public Service
         pthread_mutex_destroy(&myGameSateLock); 
     }
 
+    /** Read the match from a log written with SetRecordFile instead of
+     * connecting. A quit event is sent on the "Quit" pin once the last
+     * state in the log has been processed.
+     */
+    void SetReplayFile(std::string path)
+    {
+        myReplayFile = path;
+    }
+
+    /** Write every message received from the server to \a path.
+     */
+    void SetRecordFile(std::string path)
+    {
+        myRecordFile = path;
+    }
+
     virtual void OnInitialize();
     virtual void OnUninitialize();
     virtual void OnUpdate(FrameTime time);
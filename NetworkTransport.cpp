@@ -7,6 +7,7 @@
 #include <cstring>
 #include <cerrno>
 #include <unistd.h>
+#include <fcntl.h>
 #include "core/Debug.h"
 #include "core/Error.h"
 
@@ -65,14 +66,47 @@ void NetworkTransport::Connect(std::string hostname, std::string port)
         throw Error(Error::InvalidValue, "Failed to connect to all sockets");
 }
 
+void NetworkTransport::Replay(std::string path)
+{
+    if(myFD != -1)
+        throw Error(Error::InvalidState, "Replaying on connected socket");
+    myFD = open(path.c_str(), O_RDONLY);
+    if(myFD == -1)
+    {
+        perror(("Failed to open \""+path+"\"").c_str());
+        throw Error(Error::InvalidValue, "Failed to open replay");
+    }
+    myReplaying = true;
+    myAtEnd = false;
+}
+
+void NetworkTransport::Record(std::string path)
+{
+    myRecordFD = open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if(myRecordFD == -1)
+    {
+        perror(("Failed to open \""+path+"\"").c_str());
+        throw Error(Error::InvalidValue, "Failed to open record file");
+    }
+}
+
 void NetworkTransport::Disconnect()
 {
     close(myFD);
     myFD = -1;
+    myReplaying = false;
+    if(myRecordFD != -1)
+    {
+        close(myRecordFD);
+        myRecordFD = -1;
+    }
+    myBuffer.clear();
 }
 void NetworkTransport::Send(std::string data)
 {
     Bug(myFD == -1, "Sending on closed socket");
+    if(myReplaying)
+        return;
     if(write(myFD, data.c_str(), data.length()) == -1)
     {
         perror("Failed to send data");
@@ -82,18 +116,23 @@ void NetworkTransport::Send(std::string data)
 std::string NetworkTransport::Recv(char separator)
 {
     Bug(myFD == -1, "Reciving on closed socket");
-    std::string recv;
-    char c = 0;
-    while(c != '\n')
+    size_t end;
+    while((end = myBuffer.find(separator)) == std::string::npos)
     {
-        ssize_t r;
-        if((r = read(myFD, &c, 1)) < 1)
+        char chunk[4096];
+        ssize_t r = read(myFD, chunk, sizeof(chunk));
+        if(r == 0 && myReplaying)
+        {
+            myAtEnd = true;
+            myBuffer.clear();
+            return std::string();
+        }
+        if(r < 1)
         {
             if(r == -1 && errno == EINTR)
             {
                 Debug("N:Interrupted, exit.");
-                recv.clear();
-                break;
+                return std::string();
             }
             else
             {
@@ -101,7 +140,15 @@ std::string NetworkTransport::Recv(char separator)
                 throw Error(Error::InvalidState, "Socket failed");
             }
         }
-        recv += c;
+        myBuffer.append(chunk, r);
+    }
+    std::string recv = myBuffer.substr(0, end + 1);
+    myBuffer.erase(0, end + 1);
+    if(myRecordFD != -1 && write(myRecordFD, recv.c_str(), recv.length()) == -1)
+    {
+        perror("Failed to record data");
+        close(myRecordFD);
+        myRecordFD = -1;
     }
     return recv;
 }
@@ -6,13 +6,30 @@
 class NetworkTransport
 {
     int myFD;
+    int myRecordFD;
+    bool myReplaying;
+    bool myAtEnd;
+    std::string myBuffer;
     public:
     NetworkTransport()
-        : myFD(-1) { }
+        : myFD(-1), myRecordFD(-1), myReplaying(false), myAtEnd(false) { }
     void Connect(std::string hostname, std::string port);
+    /** Read server messages from a file written by Record instead of a
+     * socket. Anything sent is dropped.
+     */
+    void Replay(std::string path);
+    /** Append every received message to \a path.
+     */
+    void Record(std::string path);
     void Disconnect();
     void Send(std::string data);
     std::string Recv(char separator);
+    /** \returns \c true once a replayed log is exhausted.
+     */
+    bool AtEnd()
+    {
+        return myAtEnd;
+    }
 };
 
 #endif
@@ -0,0 +1,101 @@
+#include "NullContext.h"
+#include "TextCache.h"
+#include <cerrno>
+#include <cstring>
+#include "event/Event.h"
+#include "core/Debug.h"
+#include "RenderStats.h"
+
+volatile sig_atomic_t NullContext::sQuitRequested = 0;
+
+static double Seconds(const timespec &t)
+{
+    return t.tv_sec + t.tv_nsec / 1e9;
+}
+
+void NullContext::sOnSignal(int signal)
+{
+    sQuitRequested = 1;
+}
+
+NullContext::NullContext(uint frameRate)
+    : myFrameRate(frameRate), myQuitSent(false), myUpdateTime(0)
+{
+    myMiscPin = RegisterOutPin(EventClass::Misc, "Misc");
+
+    // Without SDL nobody else handles SIGINT, and NetworkService relies on
+    // it to interrupt its blocking read.
+    struct sigaction act;
+    memset(&act, 0, sizeof(act));
+    act.sa_handler = &NullContext::sOnSignal;
+    sigemptyset(&act.sa_mask);
+    sigaction(SIGINT, &act, NULL);
+    sigaction(SIGTERM, &act, NULL);
+}
+
+NullContext::~NullContext()
+{
+    signal(SIGINT, SIG_DFL);
+    signal(SIGTERM, SIG_DFL);
+}
+
+void NullContext::RequestQuit()
+{
+    sQuitRequested = 1;
+}
+
+void NullContext::OnInitialize()
+{
+    RenderStats::Headless = true;
+    clock_gettime(CLOCK_MONOTONIC, &myStartTime);
+    clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &myStartCPUTime);
+    myNextFrame = myStartTime;
+}
+
+void NullContext::OnUninitialize()
+{
+    timespec now, cpu;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &cpu);
+    double wall = Seconds(now) - Seconds(myStartTime);
+    double used = Seconds(cpu) - Seconds(myStartCPUTime);
+    uint frames = RenderStats::Frames;
+    Debug("Headless: %u frames in %.2fs, %.3fms update/frame, %.1f%% CPU",
+            frames, wall, frames ? myUpdateTime * 1000 / frames : 0.0,
+            wall > 0 ? used * 100 / wall : 0.0);
+    RenderStats::Print();
+    TextCache::Print();
+}
+
+void NullContext::OnUpdate(FrameTime time)
+{
+    timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    if(Seconds(now) > Seconds(myNextFrame))
+        myUpdateTime += Seconds(now) - Seconds(myNextFrame);
+    RenderStats::EndFrame();
+
+    if(sQuitRequested && !myQuitSent)
+    {
+        Event quit(EventClass::Misc, MiscEventCodes::Quit, this);
+        myMiscPin.Send(quit);
+        myQuitSent = true;
+    }
+
+    if(myFrameRate != 0)
+    {
+        long frame = 1000000000L / myFrameRate;
+        myNextFrame.tv_nsec += frame;
+        while(myNextFrame.tv_nsec >= 1000000000L)
+        {
+            myNextFrame.tv_nsec -= 1000000000L;
+            myNextFrame.tv_sec++;
+        }
+        if(Seconds(myNextFrame) < Seconds(now))
+            myNextFrame = now;
+        while(clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME,
+                    &myNextFrame, NULL) == EINTR);
+    }
+    else
+        myNextFrame = now;
+}
@@ -0,0 +1,42 @@
+#ifndef NULLCONTEXT_H_
+#define NULLCONTEXT_H_
+
+#include <csignal>
+#include <ctime>
+#include "entity/Service.h"
+
+using namespace anengine;
+
+/** Stand-in for SDLContext when running without a display.
+ * Paces frames, turns SIGINT/SIGTERM into a quit event on the "Misc" pin
+ * and reports frame and CPU statistics when uninitialized. No window is
+ * opened and no GL call is made.
+ */
+class NullContext : public Service
+{
+    static volatile sig_atomic_t sQuitRequested;
+    static void sOnSignal(int signal);
+
+    OutPin myMiscPin;
+    uint myFrameRate;
+    bool myQuitSent;
+    timespec myStartTime;
+    timespec myStartCPUTime;
+    timespec myNextFrame;
+    double myUpdateTime;
+
+    protected:
+    virtual void OnInitialize();
+    virtual void OnUninitialize();
+    virtual void OnUpdate(FrameTime time);
+
+    public:
+    /** \param frameRate Frames per second to pace at, 0 runs unthrottled.
+     */
+    NullContext(uint frameRate = 60);
+    virtual ~NullContext();
+
+    void RequestQuit();
+};
+
+#endif
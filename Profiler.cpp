@@ -0,0 +1,86 @@
+#include "Profiler.h"
+
+bool Profiler::Enabled = false;
+const char *Profiler::StageNames[StageCount] = {
+    "parse",
+    "handoff",
+    "update",
+    "play animation",
+    "animate",
+    "rasterize"
+};
+double Profiler::myStageTimes[StageCount];
+unsigned long Profiler::myStageCounts[StageCount];
+unsigned long Profiler::myCounters[CounterCount];
+timespec Profiler::myStartTime;
+double Profiler::myTotalTime = 0;
+thread_local Profiler::Scope *Profiler::myCurrent = NULL;
+
+static double Elapsed(const timespec &from, const timespec &to)
+{
+    return (to.tv_sec - from.tv_sec) + (to.tv_nsec - from.tv_nsec) / 1e9;
+}
+
+double Profiler::Now()
+{
+    timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return now.tv_sec + now.tv_nsec * 1e-9;
+}
+
+Profiler::Scope::Scope(Stage stage)
+    : myStage(stage), myParent(NULL), myActive(Enabled)
+{
+    if(!myActive)
+        return;
+    clock_gettime(CLOCK_MONOTONIC, &myStart);
+    myParent = myCurrent;
+    if(myParent != NULL)
+        myStageTimes[myParent->myStage] += Elapsed(myParent->myStart, myStart);
+    myCurrent = this;
+}
+
+Profiler::Scope::~Scope()
+{
+    if(!myActive)
+        return;
+    timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    myStageTimes[myStage] += Elapsed(myStart, now);
+    myStageCounts[myStage]++;
+    if(myParent != NULL)
+        myParent->myStart = now;
+    myCurrent = myParent;
+}
+
+void Profiler::Start()
+{
+    Enabled = true;
+    clock_gettime(CLOCK_MONOTONIC, &myStartTime);
+}
+
+void Profiler::Stop()
+{
+    timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    myTotalTime = Elapsed(myStartTime, now);
+    Enabled = false;
+}
+
+void Profiler::Print()
+{
+    if(myTotalTime <= 0)
+        return;
+    Debug("Benchmark: %lu turns, %lu states, %lu messages in %.3fs",
+            myCounters[Turns], myCounters[States], myCounters[Messages],
+            myTotalTime);
+    Debug("  %.1f turns/s, %.1f messages/s",
+            myCounters[Turns] / myTotalTime, myCounters[Messages] / myTotalTime);
+    for(int i = 0; i < StageCount; i++)
+    {
+        Debug("  %-16s %9.3fms total, %8.3fus avg over %lu",
+                StageNames[i], myStageTimes[i] * 1000,
+                myStageCounts[i] ? myStageTimes[i] * 1e6 / myStageCounts[i] : 0.0,
+                myStageCounts[i]);
+    }
+}
@@ -0,0 +1,73 @@
+#ifndef PROFILER_H_
+#define PROFILER_H_
+
+#include <ctime>
+#include "core/Debug.h"
+
+using namespace anengine;
+
+/** Per-stage wall time accounting for the benchmark mode.
+ * Stages are timed with Profiler::Scope. Nested scopes pause their parent,
+ * so each stage only accumulates its own time. Each stage must only ever be
+ * entered from one thread; totals are read once all threads are joined.
+ */
+class Profiler
+{
+    public:
+    enum Stage
+    {
+        Parse,
+        Handoff,
+        Update,
+        PlayAnimation,
+        Animate,
+        Rasterize,
+        StageCount
+    };
+
+    enum Counter
+    {
+        Messages,
+        States,
+        Turns,
+        CounterCount
+    };
+
+    class Scope
+    {
+        Stage myStage;
+        Scope *myParent;
+        timespec myStart;
+        bool myActive;
+        public:
+        Scope(Stage stage);
+        ~Scope();
+    };
+
+    static bool Enabled;
+
+    static void Count(Counter counter, uint amount = 1)
+    {
+        if(Enabled)
+            myCounters[counter] += amount;
+    }
+
+    static void Start();
+    static void Stop();
+    static void Print();
+
+    /** Seconds on the monotonic clock, for timings outside the stages.
+     */
+    static double Now();
+
+    private:
+    static const char *StageNames[StageCount];
+    static double myStageTimes[StageCount];
+    static unsigned long myStageCounts[StageCount];
+    static unsigned long myCounters[CounterCount];
+    static timespec myStartTime;
+    static double myTotalTime;
+    static thread_local Scope *myCurrent;
+};
+
+#endif
@@ -4,6 +4,7 @@
 #include "ProtocolHandler.h"
 #include "core/Error.h"
 #include "core/Debug.h"
+#include "Profiler.h"
 
 using namespace anengine;
 
@@ -55,7 +56,12 @@ bool ProtocolHandler::UpdateGamesate(GameState &gamestate)
         std::string line = myTransport->Recv('\n');
         if(line.size() == 0)
             return false;
-        MessageType t = Parse(line, gamestate);
+        MessageType t;
+        {
+            Profiler::Scope scope(Profiler::Parse);
+            t = Parse(line, gamestate);
+        }
+        Profiler::Count(Profiler::Messages);
         if(!InternalMessage(t))
         {
             return t == MessageType::GameState;
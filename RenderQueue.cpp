@@ -0,0 +1,61 @@
+#include "RenderQueue.h"
+
+void RenderQueue::Reset(uint count, uint states)
+{
+    myItems.resize(count);
+    mySlots.resize(count);
+    for(uint i = 0; i < count; i++)
+        myItems[i] = mySlots[i] = i;
+    myStates.assign(count, 0);
+    myStarts.assign(states + 1, count);
+    myStarts[0] = 0;
+}
+
+void RenderQueue::Fill(uint slot, uint from, std::vector<uint> &moved)
+{
+    if(slot == from)
+        return;
+    myItems[slot] = myItems[from];
+    mySlots[myItems[slot]] = slot;
+    moved.push_back(slot);
+}
+
+void RenderQueue::SetState(uint id, uint state, std::vector<uint> &moved)
+{
+    uint slot = mySlots[id];
+    uint group = myStates[id];
+    myStates[id] = state;
+    // The free slot travels to the boundary of each group on the way, the
+    // item there takes it and the group gives the boundary slot up.
+    while(group < state)
+    {
+        uint last = --myStarts[group + 1];
+        Fill(slot, last, moved);
+        slot = last;
+        group++;
+    }
+    while(group > state)
+    {
+        uint first = myStarts[group]++;
+        Fill(slot, first, moved);
+        slot = first;
+        group--;
+    }
+    if(slot != mySlots[id])
+    {
+        myItems[slot] = id;
+        mySlots[id] = slot;
+        moved.push_back(slot);
+    }
+}
+
+uint RenderQueue::StateChanges() const
+{
+    uint changes = 0;
+    for(uint i = 0; i + 1 < myStarts.size(); i++)
+    {
+        if(myStarts[i] != myStarts[i+1])
+            changes++;
+    }
+    return changes;
+}
@@ -0,0 +1,57 @@
+#ifndef RENDERQUEUE_H_
+#define RENDERQUEUE_H_
+
+#include <vector>
+#include "core/Debug.h"
+
+using namespace anengine;
+
+/** Orders draw items to keep GL state changes down.
+ * Every item sits in a slot, and the slots of items with the same program
+ * state are contiguous, the states in increasing order. Changing the
+ * state of an item moves it across the groups in between, taking one slot
+ * from each, so an update touches at most a slot per state instead of
+ * reordering every item.
+ */
+class RenderQueue
+{
+    std::vector<uint> myItems;
+    std::vector<uint> mySlots;
+    std::vector<uint> myStates;
+    std::vector<uint> myStarts;
+
+    void Fill(uint slot, uint from, std::vector<uint> &moved);
+
+    public:
+    RenderQueue() { }
+    ~RenderQueue() { }
+
+    /** Items 0 to \a count - 1, all with state 0 and item i in slot i.
+     * States range from 0 to \a states - 1.
+     */
+    void Reset(uint count, uint states);
+    /** Gives item \a id the state \a state, appending the slots that now
+     * hold another item to \a moved.
+     */
+    void SetState(uint id, uint state, std::vector<uint> &moved);
+
+    uint Count() const
+    {
+        return myItems.size();
+    }
+    /** Id of the item submitted \a slot:th.
+     */
+    uint Id(uint slot) const
+    {
+        return myItems[slot];
+    }
+    uint Slot(uint id) const
+    {
+        return mySlots[id];
+    }
+    /** Program state switches needed to submit the items in slot order.
+     */
+    uint StateChanges() const;
+};
+
+#endif
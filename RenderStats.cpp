@@ -0,0 +1,94 @@
+#include "RenderStats.h"
+
+bool RenderStats::Headless = false;
+uint RenderStats::Frames = 0;
+uint RenderStats::DrawCalls = 0;
+uint RenderStats::Vertices = 0;
+uint RenderStats::FrameDrawCalls = 0;
+uint RenderStats::FrameVertices = 0;
+uint RenderStats::UploadedBytes = 0;
+uint RenderStats::FrameUploadedBytes = 0;
+uint RenderStats::Visible = 0;
+uint RenderStats::Culled = 0;
+uint RenderStats::FrameVisible = 0;
+uint RenderStats::FrameCulled = 0;
+uint RenderStats::Reorders = 0;
+uint RenderStats::ReorderedSlots = 0;
+uint RenderStats::OrderStateChanges = 0;
+
+void RenderStats::DrawArrays(GLenum mode, GLint first, GLsizei count)
+{
+    FrameDrawCalls++;
+    FrameVertices += count;
+    if(!Headless)
+        glDrawArrays(mode, first, count);
+}
+
+void RenderStats::DrawArraysInstanced(GLenum mode, GLint first,
+        GLsizei count, GLsizei instances)
+{
+    FrameDrawCalls++;
+    FrameVertices += count * instances;
+    if(!Headless)
+        glDrawArraysInstanced(mode, first, count, instances);
+}
+
+void RenderStats::BufferData(GLenum target, GLsizeiptr size,
+        const GLvoid *data, GLenum usage)
+{
+    FrameUploadedBytes += size;
+    if(!Headless)
+        glBufferData(target, size, data, usage);
+}
+
+void RenderStats::BufferSubData(GLenum target, GLintptr offset,
+        GLsizeiptr size, const GLvoid *data)
+{
+    FrameUploadedBytes += size;
+    if(!Headless)
+        glBufferSubData(target, offset, size, data);
+}
+
+void RenderStats::CountVisibility(uint visible, uint culled)
+{
+    FrameVisible += visible;
+    FrameCulled += culled;
+}
+
+void RenderStats::CountReorder(uint slots, uint stateChanges)
+{
+    Reorders++;
+    ReorderedSlots += slots;
+    OrderStateChanges = stateChanges;
+}
+
+void RenderStats::EndFrame()
+{
+    Frames++;
+    DrawCalls += FrameDrawCalls;
+    Vertices += FrameVertices;
+    UploadedBytes += FrameUploadedBytes;
+    Visible += FrameVisible;
+    Culled += FrameCulled;
+    FrameDrawCalls = 0;
+    FrameVertices = 0;
+    FrameUploadedBytes = 0;
+    FrameVisible = 0;
+    FrameCulled = 0;
+}
+
+void RenderStats::Print()
+{
+    if(Frames == 0)
+        return;
+    Debug("Frames: %u, draw calls: %u (%.1f/frame), vertices: %u (%.1f/frame)",
+            Frames, DrawCalls, double(DrawCalls) / Frames,
+            Vertices, double(Vertices) / Frames);
+    Debug("Uploaded: %u bytes (%.1f/frame)",
+            UploadedBytes, double(UploadedBytes) / Frames);
+    Debug("Visible: %.1f/frame, culled: %.1f/frame",
+            double(Visible) / Frames, double(Culled) / Frames);
+    if(Reorders != 0)
+        Debug("Draw order changes: %u, %.1f slots moved each, state changes after the last: %u",
+                Reorders, double(ReorderedSlots) / Reorders, OrderStateChanges);
+}
@@ -0,0 +1,53 @@
+#ifndef RENDERSTATS_H_
+#define RENDERSTATS_H_
+
+#include <GL/glew.h>
+#include "core/Debug.h"
+
+using namespace anengine;
+
+/** Frame statistics for the geometry this viewer draws itself.
+ * Every OnDraw in the viewer goes through DrawArrays so draw calls can be
+ * counted, and skipped entirely when running without a graphics context.
+ */
+class RenderStats
+{
+    public:
+    static bool Headless;
+
+    static uint Frames;
+    static uint DrawCalls;
+    static uint Vertices;
+    static uint FrameDrawCalls;
+    static uint FrameVertices;
+    static uint UploadedBytes;
+    static uint FrameUploadedBytes;
+    static uint Visible;
+    static uint Culled;
+    static uint FrameVisible;
+    static uint FrameCulled;
+    static uint Reorders;
+    static uint ReorderedSlots;
+    static uint OrderStateChanges;
+
+    static void DrawArrays(GLenum mode, GLint first, GLsizei count);
+    static void DrawArraysInstanced(GLenum mode, GLint first, GLsizei count,
+            GLsizei instances);
+    /** Buffer uploads, counted like the draw calls.
+     */
+    static void BufferData(GLenum target, GLsizeiptr size, const GLvoid *data,
+            GLenum usage);
+    static void BufferSubData(GLenum target, GLintptr offset, GLsizeiptr size,
+            const GLvoid *data);
+    /** Objects the visibility pass kept and dropped this frame.
+     */
+    static void CountVisibility(uint visible, uint culled);
+    /** A change of the draw order that moved \a slots draw slots,
+     * leaving \a stateChanges switches.
+     */
+    static void CountReorder(uint slots, uint stateChanges);
+    static void EndFrame();
+    static void Print();
+};
+
+#endif
@@ -0,0 +1,126 @@
+#include "SdfFont.h"
+#include "TextRasterizer.h"
+
+textlib_sdf_atlas *SdfFont::myAtlas = NULL;
+textlib_sdf_atlas *SdfFont::myPending = NULL;
+uint SdfFont::myTicket = 0;
+Asset<Texture> SdfFont::myTexture;
+uint SdfFont::myTextureUsers = 0;
+
+void SdfFont::Request()
+{
+    if(myAtlas != NULL || myTicket != 0)
+        return;
+    // Only the worker writes myPending; Take orders it before our read.
+    myTicket = TextRasterizer::Request([]() {
+            myPending = textlib_get_sdf_atlas(Size, NULL, Spread);
+            return (SDL_Surface*)NULL;
+        });
+}
+
+const textlib_sdf_atlas *SdfFont::Get()
+{
+    SDL_Surface *unused;
+    if(myAtlas == NULL && myTicket != 0 && TextRasterizer::Take(myTicket, unused))
+    {
+        myTicket = 0;
+        myAtlas = myPending;
+        myPending = NULL;
+        if(myAtlas == NULL)
+            Debug("No distance field font, titles are not drawn");
+    }
+    return myAtlas;
+}
+
+const textlib_sdf_atlas *SdfFont::Wait()
+{
+    Request();
+    if(myAtlas == NULL && myTicket != 0)
+        TextRasterizer::Wait(myTicket);
+    return Get();
+}
+
+AssetRef<Texture> SdfFont::AcquireTexture(AssetManager *manager)
+{
+    if(myTextureUsers++ == 0)
+    {
+        myTexture = manager->CreateFromMemory<Texture>("");
+        const textlib_sdf_atlas *atlas = Wait();
+        if(atlas != NULL)
+        {
+            // White, with the distance in alpha.
+            std::vector<unsigned char> pixels(atlas->width * atlas->height * 4, 255);
+            for(int i = 0; i < atlas->width * atlas->height; i++)
+                pixels[i*4+3] = atlas->pixels[i];
+            TextureSettings settings;
+            settings.MinFilter = GL_LINEAR;
+            settings.MagFilter = GL_LINEAR;
+            settings.GenerateMipmap = false;
+            myTexture->SetData(atlas->width, atlas->height, GL_BGRA, &pixels[0], settings);
+        }
+    }
+    return myTexture;
+}
+
+void SdfFont::ReleaseTexture()
+{
+    if(myTextureUsers == 0)
+        return;
+    if(--myTextureUsers == 0)
+        myTexture.Release();
+}
+
+void SdfFont::Release()
+{
+    textlib_free_sdf_atlas(myAtlas);
+    textlib_free_sdf_atlas(myPending);
+    myAtlas = NULL;
+    myPending = NULL;
+    myTicket = 0;
+}
+
+real SdfFont::Layout(const textlib_sdf_atlas &atlas, const std::string &text,
+        std::vector<float> &vertices)
+{
+    vertices.clear();
+    int width = 0;
+    for(uint i = 0; i < text.size(); i++)
+    {
+        int c = (unsigned char)text[i] - TEXTLIB_SDF_FIRST;
+        if(c >= 0 && c < TEXTLIB_SDF_COUNT)
+            width += atlas.glyphs[c].advance;
+    }
+    if(width <= 0 || atlas.line_height <= 0)
+        return 0;
+
+    int pen = 0;
+    for(uint i = 0; i < text.size(); i++)
+    {
+        int c = (unsigned char)text[i] - TEXTLIB_SDF_FIRST;
+        if(c < 0 || c >= TEXTLIB_SDF_COUNT)
+            continue;
+        const textlib_sdf_glyph &glyph = atlas.glyphs[c];
+        // Cells of empty glyphs are only their border.
+        if(glyph.w > 2 * atlas.spread)
+        {
+            // Pixels from the top left of the line.
+            float left = pen + glyph.minx - atlas.spread;
+            float top = atlas.ascent - glyph.maxy - atlas.spread;
+            float x0 = left / width - 0.5f;
+            float x1 = (left + glyph.w) / width - 0.5f;
+            float y0 = 0.5f - top / atlas.line_height;
+            float y1 = 0.5f - (top + glyph.h) / atlas.line_height;
+            float s0 = float(glyph.x) / atlas.width;
+            float s1 = float(glyph.x + glyph.w) / atlas.width;
+            float t0 = float(glyph.y) / atlas.height;
+            float t1 = float(glyph.y + glyph.h) / atlas.height;
+            float quad[6][VertexSize] = {
+                { x0, y0, s0, t0 }, { x1, y0, s1, t0 }, { x1, y1, s1, t1 },
+                { x0, y0, s0, t0 }, { x1, y1, s1, t1 }, { x0, y1, s0, t1 }
+            };
+            vertices.insert(vertices.end(), &quad[0][0], &quad[0][0] + 6 * VertexSize);
+        }
+        pen += glyph.advance;
+    }
+    return real(width) / atlas.line_height;
+}
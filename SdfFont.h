@@ -0,0 +1,63 @@
+#ifndef SDFFONT_H_
+#define SDFFONT_H_
+
+#include <string>
+#include <vector>
+#include "textlib/textlib.h"
+#include "core/Debug.h"
+#include "math/Vector.h"
+#include "assets/AssetManager.h"
+#include "assets/Texture.h"
+
+using namespace anengine;
+
+/** The signed distance field atlas titles are drawn from, and the layout
+ * of strings into quads sampling it.
+ * The atlas is generated once, on the text rasterizer, at the first
+ * Request; Get returns NULL until it is ready. It is uploaded once too,
+ * into one texture every box shares.
+ */
+class SdfFont
+{
+    public:
+    static const int Size = 48;
+    static const int Spread = 6;
+    /** Floats per vertex: position x, y and texcoord s, t.
+     */
+    static const uint VertexSize = 4;
+
+    static void Request();
+    static const textlib_sdf_atlas *Get();
+    /** Requests the atlas if needed and blocks until it is ready. NULL
+     * if there is no font.
+     */
+    static const textlib_sdf_atlas *Wait();
+    /** The texture of the atlas, uploaded with the first user. Waits for
+     * the atlas; the texture stays empty if there is no font.
+     */
+    static AssetRef<Texture> AcquireTexture(AssetManager *manager);
+    /** Drops a user of the texture, releasing it with the last one.
+     */
+    static void ReleaseTexture();
+    /** Frees the atlas; the rasterizer must be stopped.
+     */
+    static void Release();
+
+    /** Lays \a text out as two triangles per glyph into \a vertices, in a
+     * box from -0.5 to 0.5 that is one line high and as wide as the text,
+     * y up. Returns the width of the text divided by the line height, 0
+     * if there is nothing to draw. Characters outside the atlas are
+     * skipped.
+     */
+    static real Layout(const textlib_sdf_atlas &atlas, const std::string &text,
+            std::vector<float> &vertices);
+
+    private:
+    static textlib_sdf_atlas *myAtlas;
+    static textlib_sdf_atlas *myPending;
+    static uint myTicket;
+    static Asset<Texture> myTexture;
+    static uint myTextureUsers;
+};
+
+#endif
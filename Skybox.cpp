@@ -1,5 +1,6 @@
 #include "Skybox.h"
+#include "AssetBundle.h"
 #include "assets/AssetManager.h"
 
-StaticAsset<VertexBuffer> Skybox::myVertexBuffer(AssetManager
-            ::CreateStaticFromFile<VertexBuffer>("assets/geometry/skybox.gen.vbo"));
+StaticAsset<VertexBuffer> Skybox::myVertexBuffer(AssetBundle
+            ::Static<VertexBuffer>("assets/geometry/skybox.gen.vbo"));
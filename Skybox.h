@@ -3,6 +3,7 @@
 
 #include "entity/FixedGeometry.h"
 #include "assets/AssetManager.h"
+#include "RenderStats.h"
 
 using namespace anengine;
 
@@ -18,7 +19,7 @@ class Skybox : public FixedGeometry
     }
     virtual void OnDraw(FrameTime elapsed)
     {
-        glDrawArrays(GL_TRIANGLES, 0, 36);
+        RenderStats::DrawArrays(GL_TRIANGLES, 0, 36);
     }
 
     virtual void OnCreate()
@@ -1,44 +1,138 @@
 
 #include "SoundManager.h"
+#include "core/Error.h"
+#include "Profiler.h"
+
+void SoundManager::OnInitialize()
+{
+    sndlib_init();
+    sndlib_play_wind();
+    myQuit = false;
+    if(sem_init(&myWake, 0, 0) != 0)
+        throw Error(Error::InternalError, "Failed to create semaphore");
+    if(pthread_create(&myThread, NULL, &sThreadMain, this) != 0)
+    {
+        sem_destroy(&myWake);
+        throw Error(Error::InternalError, "Failed to create thread");
+    }
+    myThreadStarted = true;
+}
+
+void SoundManager::OnUninitialize()
+{
+    if(myThreadStarted)
+    {
+        myQuit = true;
+        sem_post(&myWake);
+        pthread_join(myThread, NULL);
+        sem_destroy(&myWake);
+        myThreadStarted = false;
+    }
+    sndlib_stop_wind();
+    sndlib_quit();
+    Debug("Sounds coalesced: %u, skipped: %u, cut off: %u", myCoalesced,
+            sndlib_dropped_count(), sndlib_stolen_count());
+    Debug("Sound queue: %u played, max depth %u, %u full, latency mean %.3f ms, max %.3f ms",
+            myPlayed, myQueue.MaxDepth(), myQueue.Overflows(),
+            myPlayed ? myLatencySum / myPlayed * 1000 : 0.0, myLatencyMax * 1000);
+}
+
+void *SoundManager::sThreadMain(void *manager)
+{
+    static_cast<SoundManager*>(manager)->RunThread();
+    return NULL;
+}
+
+void SoundManager::RunThread()
+{
+    while(true)
+    {
+        while(sem_wait(&myWake) != 0)
+            ; // interrupted by a signal
+        Command command;
+        while(myQueue.Pop(command))
+        {
+            double latency = Profiler::Now() - command.Queued;
+            myLatencySum += latency;
+            if(latency > myLatencyMax)
+                myLatencyMax = latency;
+            myPlayed++;
+            Play(command.Effect, command.Duration);
+        }
+        if(myQuit)
+            return;
+    }
+}
 
 bool SoundManager::OnSoundEvent(Event &event, InPin pin)
 {
     if(event.GetEvent() == SoundEventCodes::Play)
     {
         SoundEvent &sevent = dynamic_cast<SoundEvent&>(event);
-        switch(sevent.GetSound())
+        uint sound = static_cast<uint>(sevent.GetSound());
+        if(myPending[sound])
+        {
+            myCoalesced++;
+            if(sevent.GetDuration() > myPendingDuration[sound])
+                myPendingDuration[sound] = sevent.GetDuration();
+        }
+        else
         {
-            case Sound::Laser:
-                sndlib_play_laser(sevent.GetDuration()*1000);
-                break;
-            case Sound::MotarFire:
-                sndlib_play_mortar_fire();
-                break;
-            case Sound::MotarAir:
-                sndlib_play_mortar_air(sevent.GetDuration()*1000);
-                break;
-            case Sound::MotarImpact:
-                sndlib_play_mortar_impact();
-                break;
-            case Sound::DroidFire:
-                sndlib_play_droid_fire();
-                break;
-            case Sound::DroidStep:
-                sndlib_play_droid_step();
-                break;
-            case Sound::DroidImpact:
-                sndlib_play_droid_impact();
-                break;
-            case Sound::RobotMining:
-                sndlib_play_robot_mining();
-                break;
-            case Sound::RobotRespawn:
-                sndlib_play_robot_respawn();
-                break;
-            case Sound::RobotDestruction:
-                sndlib_play_robot_destruction();
-                break;
+            myPending[sound] = true;
+            myPendingDuration[sound] = sevent.GetDuration();
         }
     }
     return true;
 }
+
+void SoundManager::OnUpdate(FrameTime time)
+{
+    for(uint i = 0; i < SoundCount; i++)
+    {
+        if(myPending[i])
+        {
+            myPending[i] = false;
+            Command command = { static_cast<Sound>(i), myPendingDuration[i], Profiler::Now() };
+            // A full queue drops the play, it would be late anyway.
+            if(myQueue.Push(command))
+                sem_post(&myWake);
+        }
+    }
+}
+
+void SoundManager::Play(Sound sound, real duration)
+{
+    switch(sound)
+    {
+        case Sound::Laser:
+            sndlib_play_laser(duration*1000);
+            break;
+        case Sound::MotarFire:
+            sndlib_play_mortar_fire();
+            break;
+        case Sound::MotarAir:
+            sndlib_play_mortar_air(duration*1000);
+            break;
+        case Sound::MotarImpact:
+            sndlib_play_mortar_impact();
+            break;
+        case Sound::DroidFire:
+            sndlib_play_droid_fire();
+            break;
+        case Sound::DroidStep:
+            sndlib_play_droid_step();
+            break;
+        case Sound::DroidImpact:
+            sndlib_play_droid_impact();
+            break;
+        case Sound::RobotMining:
+            sndlib_play_robot_mining();
+            break;
+        case Sound::RobotRespawn:
+            sndlib_play_robot_respawn();
+            break;
+        case Sound::RobotDestruction:
+            sndlib_play_robot_destruction();
+            break;
+    }
+}
@@ -4,6 +4,10 @@
 #include "GameState.h"
 #include "entity/Service.h"
 #include "sndlib/sndlib.h"
+#include "CommandQueue.h"
+#include <pthread.h>
+#include <semaphore.h>
+#include <atomic>
 
 using namespace anengine;
 
@@ -28,6 +32,7 @@ enum class Sound
     RobotDestruction,
     RobotRespawn
 };
+const uint SoundCount = static_cast<uint>(Sound::RobotRespawn) + 1;
 
 class SoundEvent : public Event
 {
@@ -51,27 +56,64 @@ class SoundEvent : public Event
     }
 };
 
+/** Plays the sounds asked for on the "Sound" pin. Events for the same
+ * sound within one frame are coalesced into one play, at the longest
+ * duration asked for; sndlib then shares its voices by priority.
+ * The plays run on the service's own audio thread, fed through a
+ * CommandQueue, so the update never waits on the mixer's lock.
+ */
 class SoundManager : public Service
 {
+    struct Command
+    {
+        Sound Effect;
+        real Duration;
+        double Queued;
+    };
+    static const uint QueueSize = 64;
+
+    bool myPending[SoundCount];
+    real myPendingDuration[SoundCount];
+    uint myCoalesced;
+    CommandQueue<Command, QueueSize> myQueue;
+    sem_t myWake;
+    pthread_t myThread;
+    bool myThreadStarted;
+    std::atomic<bool> myQuit;
+    // Written by the audio thread, read after it is joined.
+    uint myPlayed;
+    double myLatencySum;
+    double myLatencyMax;
+
     bool OnSoundEvent(Event &event, InPin pin);
+    void Play(Sound sound, real duration);
+    static void *sThreadMain(void *manager);
+    void RunThread();
     protected:
-    virtual void OnInitialize()
-    {
-        sndlib_init();
-        sndlib_play_wind();
-    }
-    virtual void OnUninitialize()
-    {
-        sndlib_stop_wind();
-        sndlib_quit();
-    }
+    virtual void OnInitialize();
+    virtual void OnUninitialize();
+    virtual void OnUpdate(FrameTime time);
     public:
     SoundManager()
+        : myCoalesced(0), myThreadStarted(false), myQuit(false), myPlayed(0),
+        myLatencySum(0), myLatencyMax(0)
     {
+        for(uint i = 0; i < SoundCount; i++)
+        {
+            myPending[i] = false;
+            myPendingDuration[i] = 0;
+        }
         RegisterInPin(SkyportEventClass::Sound, "Sound", 
                 static_cast<EventCallback>(&SoundManager::OnSoundEvent));
     }
     virtual ~SoundManager() { }
+
+    /** Plays waiting for the audio thread.
+     */
+    uint QueueDepth() const
+    {
+        return myQueue.Depth();
+    }
 };
 
 #endif
@@ -26,37 +26,101 @@ namespace anengine
 
     void Statusbox::OnDestroy()
     {
+        TextRasterizer::Cancel(myTicket);
+        myTicket = 0;
+        myHasBar = false;
         myTexture.Release();
+        FreeSegments(0);
         GUISprite::OnDestroy();
     }
 
+    void Statusbox::FreeSegments(uint first)
+    {
+        for(uint i = first; i < mySegments.size(); i++)
+        {
+            if(mySegments[i].Surface != NULL)
+                SDL_FreeSurface(mySegments[i].Surface);
+        }
+        if(first < mySegments.size())
+            mySegments.resize(first);
+    }
+
     void Statusbox::UpdateStatus()
     {
         const GameState &s = State.Get();
-        char const** names = new const char*[s.PlayerCount()];
-        int *points = new int[s.PlayerCount()];
-        char const** pweapons = new const char*[s.PlayerCount()];
-        char const** sweapons = new const char*[s.PlayerCount()];
-        int i = 0;
+        std::vector<Score> scores;
+        scores.reserve(s.PlayerCount());
         for(auto it = s.Players_begin(); it != s.Players_end(); it++)
         {
-            names[i] = it->Name.c_str();
-            points[i] = it->Score;
-            pweapons[i] = GetWeaponName(it->PrimaryWeapon);
-            sweapons[i++] = GetWeaponName(it->SecondaryWeapon);
+            Score score = { it->Name, it->Score };
+            scores.push_back(score);
+        }
+        // A dropped request may have rendered a change nobody uploaded.
+        bool force = myTicket != 0;
+        TextRasterizer::Cancel(myTicket);
+        myTicket = TextRasterizer::Request([this, scores, force]() {
+                return RenderStatus(scores, force);
+            });
+    }
+
+    SDL_Surface *Statusbox::RenderStatus(const std::vector<Score> &scores,
+            bool force)
+    {
+        uint count = scores.size();
+        if(count == 0)
+            return NULL;
+        int fontSize = textlib_get_stats_font_size(count);
+        bool changed = force || count != mySegments.size();
+        FreeSegments(count);
+        Segment empty = { "", 0, false, 0, NULL };
+        mySegments.resize(count, empty);
+        for(uint i = 0; i < count; i++)
+        {
+            Segment &seg = mySegments[i];
+            bool last = i == count - 1;
+            if(seg.Surface != NULL && seg.Name == scores[i].Name &&
+                    seg.Score == scores[i].Points && seg.Last == last &&
+                    seg.FontSize == fontSize)
+                continue;
+            if(seg.Surface != NULL)
+                SDL_FreeSurface(seg.Surface);
+            seg.Name = scores[i].Name;
+            seg.Score = scores[i].Points;
+            seg.Last = last;
+            seg.FontSize = fontSize;
+            seg.Surface = textlib_get_stats_segment(seg.Name.c_str(),
+                    seg.Score, last, fontSize);
+            changed = true;
+        }
+        if(!changed)
+            return NULL;
+
+        mySurfaces.resize(count);
+        for(uint i = 0; i < count; i++)
+        {
+            if(mySegments[i].Surface == NULL)
+                return NULL;
+            mySurfaces[i] = mySegments[i].Surface;
         }
-        SDL_Surface *stat = textlib_get_stats(s.PlayerCount(), names, points, 
-                pweapons, sweapons, 1920);
-        if(stat != NULL)
+        return textlib_compose_stats(count, &mySurfaces[0], 1920);
+    }
+
+    void Statusbox::OnDraw(FrameTime elapsed)
+    {
+        SDL_Surface *stat = NULL;
+        if(myTicket != 0 && TextRasterizer::Take(myTicket, stat))
         {
-            myTexture->SetData(stat->w, stat->h, GL_BGRA, stat->pixels);
-            real width = Size.Get()[Width];
-            Size.Set(SizeF2(width, stat->h * width / stat->w));
-            SDL_FreeSurface(stat);
+            myTicket = 0;
+            if(stat != NULL)
+            {
+                myTexture->SetData(stat->w, stat->h, GL_BGRA, stat->pixels);
+                real width = Size.Get()[Width];
+                Size.Set(SizeF2(width, stat->h * width / stat->w));
+                SDL_FreeSurface(stat);
+                myHasBar = true;
+            }
         }
-        delete [] names;
-        delete [] points;
-        delete [] pweapons;
-        delete [] sweapons;
+        if(myHasBar)
+            GUISprite::OnDraw(elapsed);
     }
 };
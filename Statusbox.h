@@ -1,28 +1,61 @@
 #ifndef STATUSBOX_H_
 #define STATUSBOX_H_
 
+#include <vector>
+#include <string>
+#include <SDL.h>
 #include "entity/GUISprite.h"
 #include "GameState.h"
+#include "TextRasterizer.h"
 
 namespace anengine
 {
+    /** Score bar of all players. Each player's text is rendered once and
+     * kept until their score or the layout changes; the bar is only
+     * recomposed and uploaded when one of them was re-rendered. Rendering
+     * runs on the text rasterizer, the segments are only touched there.
+     */
     class Statusbox : public GUISprite
     {
+        struct Segment
+        {
+            std::string Name;
+            int Score;
+            bool Last;
+            int FontSize;
+            SDL_Surface *Surface;
+        };
+        struct Score
+        {
+            std::string Name;
+            int Points;
+        };
         Asset<Texture> myTexture;
+        std::vector<Segment> mySegments;
+        std::vector<SDL_Surface*> mySurfaces;
+        uint myTicket;
+        bool myHasBar;
         void UpdateStatus();
+        SDL_Surface *RenderStatus(const std::vector<Score> &scores, bool force);
+        void FreeSegments(uint first);
         protected:
         virtual void OnPropertyChanged(const PropertyInfo *id, bool implicit);
         virtual void OnCreate();
         virtual void OnDestroy();
+        virtual void OnDraw(FrameTime elapsed);
         public:
         static PropertyInfo StateProperty;
         Property<GameState> State;
 
         Statusbox() 
-            : GUISprite(AssetRef<Texture>()),
+            : GUISprite(AssetRef<Texture>()), myTicket(0), myHasBar(false),
             State(&StateProperty, this)
         { }
-        virtual ~Statusbox() { }
+        virtual ~Statusbox()
+        {
+            TextRasterizer::Cancel(myTicket);
+            FreeSegments(0);
+        }
     };
 };
 
@@ -0,0 +1,74 @@
+#include "TextCache.h"
+#include "core/Debug.h"
+
+uint TextCache::Hits = 0;
+uint TextCache::Misses = 0;
+
+bool TextCache::Key::operator<(const Key &other) const
+{
+    if(Size != other.Size)
+        return Size < other.Size;
+    for(int i = 0; i < 4; i++)
+    {
+        if(Color[i] != other.Color[i])
+            return Color[i] < other.Color[i];
+    }
+    return Text < other.Text;
+}
+
+const TextCache::Entry *TextCache::Find(const Key &key)
+{
+    std::map<Key, EntryList::iterator>::iterator it = myIndex.find(key);
+    if(it == myIndex.end())
+    {
+        Misses++;
+        return NULL;
+    }
+    Hits++;
+    myEntries.splice(myEntries.begin(), myEntries, it->second);
+    return &it->second->second;
+}
+
+const TextCache::Entry &TextCache::Insert(const Key &key,
+        Asset<Texture> image, int width, int height)
+{
+    std::map<Key, EntryList::iterator>::iterator it = myIndex.find(key);
+    if(it != myIndex.end())
+    {
+        Entry &old = it->second->second;
+        myBytes -= old.Width * old.Height * 4;
+        old.Image.Release();
+        myEntries.erase(it->second);
+        myIndex.erase(it);
+    }
+    Entry entry = { image, width, height };
+    myEntries.push_front(std::make_pair(key, entry));
+    myIndex[key] = myEntries.begin();
+    myBytes += width * height * 4;
+    while(myBytes > myCapacity && myEntries.size() > 1)
+    {
+        Entry &last = myEntries.back().second;
+        myBytes -= last.Width * last.Height * 4;
+        last.Image.Release();
+        myIndex.erase(myEntries.back().first);
+        myEntries.pop_back();
+    }
+    return myEntries.front().second;
+}
+
+void TextCache::Clear()
+{
+    for(EntryList::iterator it = myEntries.begin(); it != myEntries.end(); it++)
+        it->second.Image.Release();
+    myEntries.clear();
+    myIndex.clear();
+    myBytes = 0;
+}
+
+void TextCache::Print()
+{
+    if(Hits + Misses == 0)
+        return;
+    Debug("Text cache: %u hits, %u misses (%.1f%% hits)", Hits, Misses,
+            100.0 * Hits / (Hits + Misses));
+}
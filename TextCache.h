@@ -0,0 +1,82 @@
+#ifndef TEXTCACHE_H_
+#define TEXTCACHE_H_
+
+#include <list>
+#include <map>
+#include <string>
+#include "assets/AssetManager.h"
+#include "assets/Texture.h"
+#include "math/Vector.h"
+
+using namespace anengine;
+
+/** Least recently used cache of rendered text textures.
+ * Entries are keyed by string, colour and font size and count
+ * width * height * 4 bytes against the capacity. Showing a cached string
+ * is a texture rebind instead of a render and upload.
+ */
+class TextCache
+{
+    public:
+    static const size_t DefaultCapacity = 4 << 20;
+
+    struct Key
+    {
+        std::string Text;
+        ColorRGBA Color;
+        int Size;
+
+        bool operator<(const Key &other) const;
+    };
+    struct Entry
+    {
+        Asset<Texture> Image;
+        int Width;
+        int Height;
+    };
+
+    /** Lookups over all caches.
+     */
+    static uint Hits;
+    static uint Misses;
+    static void Print();
+
+    private:
+    typedef std::list<std::pair<Key, Entry> > EntryList;
+    EntryList myEntries;
+    std::map<Key, EntryList::iterator> myIndex;
+    size_t myBytes;
+    size_t myCapacity;
+
+    public:
+    TextCache(size_t capacity = DefaultCapacity)
+        : myBytes(0), myCapacity(capacity) { }
+    ~TextCache() { }
+
+    /** Returns the entry for \a key and marks it used, NULL on a miss.
+     */
+    const Entry *Find(const Key &key);
+    /** Adds a texture and evicts the least recently used entries until
+     * the cache fits its capacity again. The new entry is always kept.
+     */
+    const Entry &Insert(const Key &key, Asset<Texture> image, int width,
+            int height);
+    /** Releases all textures, needed before the scene goes away.
+     */
+    void Clear();
+
+    void SetCapacity(size_t capacity)
+    {
+        myCapacity = capacity;
+    }
+    size_t GetBytes() const
+    {
+        return myBytes;
+    }
+    uint Count() const
+    {
+        return myEntries.size();
+    }
+};
+
+#endif
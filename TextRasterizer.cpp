@@ -0,0 +1,151 @@
+#include "TextRasterizer.h"
+#include "core/Error.h"
+#include "Profiler.h"
+#include <deque>
+#include <map>
+
+namespace
+{
+    struct Pending
+    {
+        uint Ticket;
+        TextRasterizer::Job Work;
+    };
+
+    pthread_mutex_t myLock = PTHREAD_MUTEX_INITIALIZER;
+    pthread_cond_t myWorkCond = PTHREAD_COND_INITIALIZER;
+    pthread_cond_t myDoneCond = PTHREAD_COND_INITIALIZER;
+    pthread_t myThread;
+    bool myStarted = false;
+    bool myQuit = false;
+    uint myNextTicket = 1;
+    uint myRunning = 0;
+    std::deque<Pending> myQueue;
+    std::map<uint, SDL_Surface*> myResults;
+}
+
+uint TextRasterizer::Request(const Job &job)
+{
+    pthread_mutex_lock(&myLock);
+    if(!myStarted)
+    {
+        myQuit = false;
+        if(pthread_create(&myThread, NULL, &sWorkerMain, NULL) != 0)
+        {
+            pthread_mutex_unlock(&myLock);
+            throw Error(Error::InternalError, "Failed to create thread");
+        }
+        myStarted = true;
+    }
+    uint ticket = myNextTicket++;
+    if(myNextTicket == 0)
+        myNextTicket = 1;
+    Pending pending = { ticket, job };
+    myQueue.push_back(pending);
+    pthread_cond_signal(&myWorkCond);
+    pthread_mutex_unlock(&myLock);
+    return ticket;
+}
+
+bool TextRasterizer::Take(uint ticket, SDL_Surface *&surface)
+{
+    pthread_mutex_lock(&myLock);
+    std::map<uint, SDL_Surface*>::iterator it = myResults.find(ticket);
+    bool done = it != myResults.end();
+    if(done)
+    {
+        surface = it->second;
+        myResults.erase(it);
+    }
+    pthread_mutex_unlock(&myLock);
+    return done;
+}
+
+void TextRasterizer::Wait(uint ticket)
+{
+    pthread_mutex_lock(&myLock);
+    while(myResults.find(ticket) == myResults.end())
+        pthread_cond_wait(&myDoneCond, &myLock);
+    pthread_mutex_unlock(&myLock);
+}
+
+void TextRasterizer::Cancel(uint ticket)
+{
+    if(ticket == 0)
+        return;
+    pthread_mutex_lock(&myLock);
+    for(std::deque<Pending>::iterator it = myQueue.begin(); it != myQueue.end(); it++)
+    {
+        if(it->Ticket == ticket)
+        {
+            myQueue.erase(it);
+            pthread_mutex_unlock(&myLock);
+            return;
+        }
+    }
+    while(myRunning == ticket)
+        pthread_cond_wait(&myDoneCond, &myLock);
+    std::map<uint, SDL_Surface*>::iterator it = myResults.find(ticket);
+    if(it != myResults.end())
+    {
+        if(it->second != NULL)
+            SDL_FreeSurface(it->second);
+        myResults.erase(it);
+    }
+    pthread_mutex_unlock(&myLock);
+}
+
+void TextRasterizer::Stop()
+{
+    pthread_mutex_lock(&myLock);
+    if(!myStarted)
+    {
+        pthread_mutex_unlock(&myLock);
+        return;
+    }
+    myQuit = true;
+    pthread_cond_broadcast(&myWorkCond);
+    pthread_mutex_unlock(&myLock);
+    if(pthread_join(myThread, NULL) != 0)
+        throw Error(Error::InternalError, "Failed to join thread");
+
+    pthread_mutex_lock(&myLock);
+    myStarted = false;
+    for(std::map<uint, SDL_Surface*>::iterator it = myResults.begin();
+            it != myResults.end(); it++)
+    {
+        if(it->second != NULL)
+            SDL_FreeSurface(it->second);
+    }
+    myResults.clear();
+    pthread_mutex_unlock(&myLock);
+}
+
+void *TextRasterizer::sWorkerMain(void *)
+{
+    pthread_mutex_lock(&myLock);
+    while(true)
+    {
+        while(myQueue.empty() && !myQuit)
+            pthread_cond_wait(&myWorkCond, &myLock);
+        if(myQueue.empty())
+            break;
+        Pending pending = myQueue.front();
+        myQueue.pop_front();
+        myRunning = pending.Ticket;
+        pthread_mutex_unlock(&myLock);
+
+        SDL_Surface *surface;
+        {
+            Profiler::Scope scope(Profiler::Rasterize);
+            surface = pending.Work();
+        }
+
+        pthread_mutex_lock(&myLock);
+        myResults[pending.Ticket] = surface;
+        myRunning = 0;
+        pthread_cond_broadcast(&myDoneCond);
+    }
+    pthread_mutex_unlock(&myLock);
+    return NULL;
+}
@@ -0,0 +1,47 @@
+#ifndef TEXTRASTERIZER_H_
+#define TEXTRASTERIZER_H_
+
+#include <functional>
+#include <pthread.h>
+#include <SDL.h>
+#include "core/Debug.h"
+
+using namespace anengine;
+
+/** Worker thread that runs all textlib rendering.
+ * textlib and SDL_ttf are not thread safe, so every text surface is made
+ * by jobs on this one thread. Callers get a ticket, keep showing what they
+ * have and poll with Take from their draw, uploading the surface once it
+ * is ready. The worker is started with the first request.
+ */
+class TextRasterizer
+{
+    public:
+    typedef std::function<SDL_Surface*()> Job;
+
+    /** Queues \a job and returns its ticket, never 0.
+     */
+    static uint Request(const Job &job);
+    /** True once the job for \a ticket has run. Its surface, which the
+     * caller now owns and may be NULL, is stored in \a surface and the
+     * ticket is done.
+     */
+    static bool Take(uint ticket, SDL_Surface *&surface);
+    /** Blocks until the job for \a ticket has run, so Take succeeds. The
+     * ticket must not have been taken or canceled.
+     */
+    static void Wait(uint ticket);
+    /** Drops the request for \a ticket, waiting for it if it is running,
+     * and frees its surface. Does nothing for ticket 0.
+     */
+    static void Cancel(uint ticket);
+    /** Runs the queued jobs and joins the worker. Must be called before
+     * main returns, while SDL and the queue are still there.
+     */
+    static void Stop();
+
+    private:
+    static void *sWorkerMain(void *);
+};
+
+#endif
@@ -1,6 +1,9 @@
 
 #include "Textbox.h"
+#include "AssetBundle.h"
 #include "textlib/textlib.h"
+#include "TextRasterizer.h"
+#include "SdfFont.h"
 
 namespace anengine
 {
@@ -8,17 +11,29 @@ namespace anengine
     PropertyInfo Textbox::TextProperty("Text", typeid(Textbox));
 
     Textbox::TextlibInit Textbox::myTexlibInit;
+    bool Textbox::UseSdf = false;
+    TextCache Textbox::myCache;
+    uint Textbox::myCacheUsers = 0;
+
+    StaticAsset<Program> Textbox::SdfProgram(AssetBundle
+            ::Static<Program>("assets/shaders/SdfText.sp"));
+    // The engine binds this for us, DrawSdf points the attributes at the text.
+    StaticAsset<VertexBuffer> Textbox::SdfVertexBuffer(AssetManager::CreateStaticFromMemory<VertexBuffer>(
+    "A2 position float2 false 16 0 texcoord float2 false 16 8 1 4"
+    "0.0 0.0 0.0 0.0 "));
 
     Textbox::TextlibInit::TextlibInit()
     {
         Debug("Textlib init");
         textlib_initialize();
-        textlib_set_font(72, NULL);
+        textlib_set_font(FontSize, NULL);
         textlib_set_quality(TEXT_QUALITY_HIGH);
     }
     Textbox::TextlibInit::~TextlibInit()
     {
         Debug("Textlib quit");
+        // main has stopped the rasterizer, its queue may be gone by now.
+        SdfFont::Release();
         textlib_quit();
     }
 
@@ -35,7 +50,18 @@ namespace anengine
 
     void Textbox::OnCreate()
     {
-        myTexture = Scene.Get()->GetAssetManager()->CreateFromMemory<Texture>("");
+        AssetManager *manager = Scene.Get()->GetAssetManager();
+        if(mySdf)
+        {
+            if(!HasProgram())
+                SetProgram(SdfProgram.Get(manager));
+            myTexture = SdfFont::AcquireTexture(manager);
+        }
+        else
+        {
+            myTexture = manager->CreateFromMemory<Texture>("");
+            myCacheUsers++;
+        }
         UpdateText();
         SetTexture(myTexture);
         GUISprite::OnCreate();
@@ -43,23 +69,146 @@ namespace anengine
 
     void Textbox::OnDestroy()
     {
+        TextRasterizer::Cancel(myTicket);
+        myTicket = 0;
+        myStale = true;
+        if(myTextBuffer != 0)
+            glDeleteBuffers(1, &myTextBuffer);
+        myTextBuffer = 0;
+        myProgramId = 0;
         myTexture.Release();
+        if(mySdf)
+            SdfFont::ReleaseTexture();
+        // The textures must go before the scene does.
+        else if(--myCacheUsers == 0)
+            myCache.Clear();
         GUISprite::OnDestroy();
     }
 
+    void Textbox::OnNewProgram()
+    {
+        if(mySdf)
+        {
+            ColorRGBA c = Color.Get();
+            ProgramState().SetUniform("Color", VectorF4(c[R] / 255.0f,
+                        c[G] / 255.0f, c[B] / 255.0f, c[A] / 255.0f));
+        }
+        GUISprite::OnNewProgram();
+    }
+
     void Textbox::UpdateText()
     {
         ColorRGBA c = Color.Get();
+        if(mySdf)
+        {
+            // Created boxes hold the texture, so the atlas is ready.
+            const textlib_sdf_atlas *atlas = SdfFont::Get();
+            Visible.Set(atlas != NULL && !Text.Get().empty());
+            if(HasProgram())
+                ProgramState().SetUniform("Color", VectorF4(c[R] / 255.0f,
+                            c[G] / 255.0f, c[B] / 255.0f, c[A] / 255.0f));
+            if(atlas == NULL)
+                return;
+            real aspect = SdfFont::Layout(*atlas, Text.Get(), myTextVertices);
+            if(aspect > 0)
+            {
+                real height = Size.Get()[Height];
+                Size.Set(SizeF2(aspect * height, height));
+            }
+            myTextDirty = true;
+            return;
+        }
+        TextRasterizer::Cancel(myTicket);
+        myTicket = 0;
+        // A hidden box's texture holds an old text, keep it hidden until
+        // the new one is ready. A shown one keeps its text until then.
+        myStale |= !Visible.Get();
         Visible.Set(!Text.Get().empty());
-        if(Visible.Get())
+        if(!Visible.Get())
+            return;
+        TextCache::Key key = { Text.Get(), c, FontSize };
+        const TextCache::Entry *entry = myCache.Find(key);
+        if(entry != NULL)
+        {
+            ShowEntry(*entry);
+            return;
+        }
+        myPendingKey = key;
+        std::string text = Text.Get();
+        myTicket = TextRasterizer::Request([text, c]() {
+                return textlib_get_text(text.c_str(), c[R], c[G], c[B]);
+            });
+    }
+
+    void Textbox::ShowEntry(const TextCache::Entry &entry)
+    {
+        myTexture = entry.Image;
+        SetTexture(myTexture);
+        real height = Size.Get()[Height];
+        Size.Set(SizeF2(entry.Width * height / entry.Height, height));
+        myStale = false;
+    }
+
+    void Textbox::OnDraw(FrameTime elapsed)
+    {
+        if(mySdf)
+        {
+            DrawSdf();
+            return;
+        }
+        SDL_Surface *text = NULL;
+        if(myTicket != 0 && TextRasterizer::Take(myTicket, text))
+        {
+            myTicket = 0;
+            if(text != NULL)
+            {
+                Asset<Texture> image = Scene.Get()->GetAssetManager()
+                    ->CreateFromMemory<Texture>("");
+                SDL_LockSurface(text);
+                image->SetData(text->w, text->h, GL_BGRA, text->pixels);
+                SDL_UnlockSurface(text);
+                ShowEntry(myCache.Insert(myPendingKey, image, text->w, text->h));
+                SDL_FreeSurface(text);
+            }
+        }
+        if(!myStale)
+            GUISprite::OnDraw(elapsed);
+    }
+
+    void Textbox::DrawSdf()
+    {
+        GLint program = 0;
+        glGetIntegerv(GL_CURRENT_PROGRAM, &program);
+        if(program != myProgramId)
+        {
+            myProgramId = program;
+            myPositionAttrib = glGetAttribLocation(program, "position");
+            myTexcoordAttrib = glGetAttribLocation(program, "texcoord");
+        }
+
+        GLint arrayBuffer = 0;
+        glGetIntegerv(GL_ARRAY_BUFFER_BINDING, &arrayBuffer);
+        if(myTextBuffer == 0)
+            glGenBuffers(1, &myTextBuffer);
+        glBindBuffer(GL_ARRAY_BUFFER, myTextBuffer);
+        if(myTextDirty)
         {
-            SDL_Surface *text = textlib_get_text(Text.Get().c_str(), c[R],c[G],c[B]);
-            SDL_LockSurface(text);
-            myTexture->SetData(text->w, text->h, GL_BGRA, text->pixels);
-            real height = Size.Get()[Height];
-            Size.Set(SizeF2(text->w * height / text->h, height));
-            SDL_UnlockSurface(text);
-            SDL_FreeSurface(text);
+            RenderStats::BufferData(GL_ARRAY_BUFFER,
+                    myTextVertices.size() * sizeof(float),
+                    myTextVertices.empty() ? NULL : &myTextVertices[0],
+                    GL_DYNAMIC_DRAW);
+            myTextDirty = false;
         }
+        if(myPositionAttrib != -1)
+            glVertexAttribPointer(myPositionAttrib, 2, GL_FLOAT, GL_FALSE,
+                    SdfFont::VertexSize * sizeof(float), (const GLvoid*)0);
+        if(myTexcoordAttrib != -1)
+            glVertexAttribPointer(myTexcoordAttrib, 2, GL_FLOAT, GL_FALSE,
+                    SdfFont::VertexSize * sizeof(float),
+                    (const GLvoid*)(2 * sizeof(float)));
+        if(!myTextVertices.empty())
+            RenderStats::DrawArrays(GL_TRIANGLES, 0,
+                    myTextVertices.size() / SdfFont::VertexSize);
+        glBindBuffer(GL_ARRAY_BUFFER, arrayBuffer);
     }
 };
@@ -1,10 +1,20 @@
 #ifndef TEXTBOX_H_
 #define TEXTBOX_H_
 
+#include <vector>
 #include "entity/GUISprite.h"
+#include "RenderStats.h"
+#include "TextCache.h"
 
 namespace anengine
 {
+    /** Single line of text. By default the text is rasterized into a
+     * texture, and recently shown strings are kept in one TextCache all
+     * boxes share; with
+     * UseSdf it is laid out as quads over the
+     * shared distance field font instead, so a change only rebuilds a few
+     * vertices and the text stays sharp at any size.
+     */
     class Textbox : public GUISprite
     {
         struct TextlibInit
@@ -13,24 +23,65 @@ namespace anengine
             ~TextlibInit();
         };
         static TextlibInit myTexlibInit;
+        static StaticAsset<Program> SdfProgram;
+        static StaticAsset<VertexBuffer> SdfVertexBuffer;
         Asset<Texture> myTexture;
+        static TextCache myCache;
+        static uint myCacheUsers;
+        TextCache::Key myPendingKey;
+        uint myTicket;
+        bool myStale;
+        bool mySdf;
+        bool myTextDirty;
+        std::vector<float> myTextVertices;
+        GLuint myTextBuffer;
+        GLint myProgramId;
+        GLint myPositionAttrib;
+        GLint myTexcoordAttrib;
         void UpdateText();
+        void ShowEntry(const TextCache::Entry &entry);
+        void DrawSdf();
         protected:
         virtual void OnPropertyChanged(const PropertyInfo *id, bool implicit);
         virtual void OnCreate();
         virtual void OnDestroy();
+        virtual void OnDraw(FrameTime elapsed);
+        virtual void OnNewProgram();
         public:
+        /** Draw Textboxes created from now on with the distance field font.
+         */
+        static bool UseSdf;
+        /** Point size of the rasterized text.
+         */
+        static const int FontSize = 72;
         static PropertyInfo ColorProperty;
         Property<ColorRGBA> Color;
         static PropertyInfo TextProperty;
         Property<std::string> Text;
 
         Textbox() 
-            : GUISprite(AssetRef<Texture>()),
+            : GUISprite(AssetRef<Texture>()), myTicket(0), myStale(true),
+            mySdf(UseSdf), myTextDirty(false),
+            myTextBuffer(0), myProgramId(0), myPositionAttrib(-1),
+            myTexcoordAttrib(-1),
             Color(&ColorProperty, this),
             Text(&TextProperty, this, EventDirection::None, "F")
         { }
         virtual ~Textbox() { }
+
+        /** Memory the cached text textures of all boxes may use.
+         */
+        static void SetCacheCapacity(size_t bytes)
+        {
+            myCache.SetCapacity(bytes);
+        }
+
+        virtual AssetRef<VertexBuffer> GetGeometry(AssetManager *manager)
+        {
+            if(mySdf)
+                return SdfVertexBuffer.Get(manager);
+            return GUISprite::GetGeometry(manager);
+        }
     };
 };
 
@@ -0,0 +1,67 @@
+#include "TextureFile.h"
+#include "core/Error.h"
+#include <cstring>
+
+namespace
+{
+    const size_t HeaderSize = 24;
+}
+
+TextureFile::TextureFile(const char *path)
+    : myFile(path), myWidth(0), myHeight(0), myLevelCount(0)
+{
+    if(myFile.Empty())
+    {
+        Debug("Failed to map %s", path);
+        throw Error(Error::InvalidValue, "Failed to map packed texture");
+    }
+    if(!Parse())
+    {
+        Debug("Not a packed texture: %s", path);
+        throw Error(Error::InvalidValue, "Not a packed texture");
+    }
+}
+
+TextureFile::TextureFile(const void *bytes, size_t size)
+    : myFile(bytes, size), myWidth(0), myHeight(0), myLevelCount(0)
+{
+    if(!Parse())
+        throw Error(Error::InvalidValue, "Not a packed texture");
+}
+
+bool TextureFile::Parse()
+{
+    const unsigned char *bytes = myFile.Data();
+    size_t size = myFile.Size();
+    if(size < HeaderSize)
+        return false;
+    myWidth = MappedFile::ReadU32(bytes + 8);
+    myHeight = MappedFile::ReadU32(bytes + 12);
+    myLevelCount = MappedFile::ReadU32(bytes + 16);
+    if(memcmp(bytes, "RTEX", 4) != 0 || MappedFile::ReadU32(bytes + 4) != 1 ||
+            myWidth == 0 || myHeight == 0 ||
+            myLevelCount == 0 || myLevelCount > MaxLevels ||
+            HeaderSize + myLevelCount * 8 > size)
+        return false;
+    for(uint i = 0; i < myLevelCount; i++)
+    {
+        uint32_t offset = MappedFile::ReadU32(bytes + HeaderSize + i * 8);
+        uint32_t length = MappedFile::ReadU32(bytes + HeaderSize + i * 8 + 4);
+        if(length != LevelWidth(i) * LevelHeight(i) * 4 ||
+                offset > size || length > size - offset)
+            return false;
+        myLevels[i] = bytes + offset;
+    }
+    return true;
+}
+
+std::string TextureFile::PackedPath(const char *path)
+{
+    std::string packed(path);
+    size_t dot = packed.rfind(".png");
+    if(dot != std::string::npos && dot + 4 == packed.size())
+        packed.replace(dot, 4, ".rtex");
+    else
+        packed += ".rtex";
+    return packed;
+}
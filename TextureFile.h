@@ -0,0 +1,69 @@
+#ifndef TEXTUREFILE_H_
+#define TEXTUREFILE_H_
+
+#include <cstddef>
+#include <string>
+#include "MappedFile.h"
+
+using namespace anengine;
+
+/** Read only mapping of a packed texture, the .gen.rtex files the assets
+ * build writes next to each .gen.png (see assets/generators/texpack.c):
+ * BGRA pixels with the whole mip chain, ready to upload as they are.
+ * The viewer uploads only level 0 for now, see TextureLoader.
+ */
+class TextureFile
+{
+    static const uint MaxLevels = 32;
+
+    MappedFile myFile;
+    uint myWidth;
+    uint myHeight;
+    uint myLevelCount;
+    const unsigned char *myLevels[MaxLevels];
+
+    TextureFile(const TextureFile &);
+    TextureFile &operator=(const TextureFile &);
+    bool Parse();
+
+    public:
+    /** Maps \a path, throws if it is not a packed texture.
+     */
+    TextureFile(const char *path);
+    /** Reads the \a size bytes at \a bytes, which must stay valid, as a
+     * packed texture. Throws if they are not one.
+     */
+    TextureFile(const void *bytes, size_t size);
+    ~TextureFile() { }
+
+    /** Name of the packed file written for the PNG \a path.
+     */
+    static std::string PackedPath(const char *path);
+
+    uint Width() const
+    {
+        return myWidth;
+    }
+    uint Height() const
+    {
+        return myHeight;
+    }
+    uint LevelCount() const
+    {
+        return myLevelCount;
+    }
+    uint LevelWidth(uint level) const
+    {
+        return myWidth >> level ? myWidth >> level : 1;
+    }
+    uint LevelHeight(uint level) const
+    {
+        return myHeight >> level ? myHeight >> level : 1;
+    }
+    const unsigned char *Level(uint level) const
+    {
+        return myLevels[level];
+    }
+};
+
+#endif
@@ -0,0 +1,166 @@
+#include "TextureLoader.h"
+#include "AssetBundle.h"
+#include "core/Error.h"
+#include "Profiler.h"
+#include <cstring>
+#include <unistd.h>
+#include <png.h>
+
+TextureLoader::TextureLoader()
+    : myThreadCount(0), myNext(0), myStarted(false), myStartTime(0), myDecodeTime(0)
+{
+    pthread_mutex_init(&myLock, NULL);
+}
+
+TextureLoader::~TextureLoader()
+{
+    Wait();
+    Release();
+    pthread_mutex_destroy(&myLock);
+}
+
+AssetRef<Texture> TextureLoader::Load(AssetManager *manager, const char *path)
+{
+    std::string packed = TextureFile::PackedPath(path);
+    const char *bundled;
+    size_t size;
+    Pending pending;
+    pending.Path = path;
+    pending.File = NULL;
+    pending.Width = pending.Height = 0;
+    if(AssetBundle::Default().Find(packed.c_str(), bundled, size))
+        pending.File = new TextureFile(bundled, size);
+    else if(access(packed.c_str(), R_OK) == 0)
+        pending.File = new TextureFile(packed.c_str());
+
+    AssetRef<Texture> ref = manager->CreateFromMemory<Texture>("");
+    pending.Image = ref;
+    myPending.push_back(pending);
+    return ref;
+}
+
+void TextureLoader::Start()
+{
+    myStarted = true;
+    myStartTime = Profiler::Now();
+    for(myThreadCount = 0; myThreadCount < MaxThreads &&
+            myThreadCount < myPending.size(); myThreadCount++)
+    {
+        if(pthread_create(&myThreads[myThreadCount], NULL, &sWorkerMain, this) != 0)
+            break;
+    }
+    if(myThreadCount == 0)
+        Work();
+}
+
+void *TextureLoader::sWorkerMain(void *loader)
+{
+    static_cast<TextureLoader*>(loader)->Work();
+    return NULL;
+}
+
+void TextureLoader::Work()
+{
+    while(true)
+    {
+        pthread_mutex_lock(&myLock);
+        uint index = myNext++;
+        pthread_mutex_unlock(&myLock);
+        if(index >= myPending.size())
+            break;
+        Decode(myPending[index]);
+    }
+    pthread_mutex_lock(&myLock);
+    myDecodeTime = Profiler::Now() - myStartTime;
+    pthread_mutex_unlock(&myLock);
+}
+
+void TextureLoader::Decode(Pending &pending)
+{
+    if(pending.File != NULL)
+    {
+        // Fault the pages in here rather than during the upload.
+        const TextureFile &file = *pending.File;
+        volatile unsigned char sum = 0;
+        size_t bytes = file.Width() * file.Height() * 4;
+        for(size_t i = 0; i < bytes; i += 4096)
+            sum += file.Level(0)[i];
+        return;
+    }
+
+    png_image image;
+    memset(&image, 0, sizeof(image));
+    image.version = PNG_IMAGE_VERSION;
+    if(!png_image_begin_read_from_file(&image, pending.Path.c_str()))
+        return;
+    image.format = PNG_FORMAT_BGRA;
+    pending.Pixels.resize(PNG_IMAGE_SIZE(image));
+    if(!png_image_finish_read(&image, NULL, &pending.Pixels[0], 0, NULL))
+    {
+        pending.Pixels.clear();
+        return;
+    }
+    pending.Width = image.width;
+    pending.Height = image.height;
+}
+
+void TextureLoader::Wait()
+{
+    for(uint i = 0; i < myThreadCount; i++)
+        pthread_join(myThreads[i], NULL);
+    myThreadCount = 0;
+}
+
+void TextureLoader::OnInitialize()
+{
+    if(!myStarted)
+        Start();
+    double waitStart = Profiler::Now();
+    Wait();
+    double uploadStart = Profiler::Now();
+    for(uint i = 0; i < myPending.size(); i++)
+    {
+        if(myPending[i].File == NULL && myPending[i].Pixels.empty())
+        {
+            Debug("Failed to load %s", myPending[i].Path.c_str());
+            Release();
+            throw Error(Error::InvalidValue, "Failed to load texture");
+        }
+    }
+    for(uint i = 0; i < myPending.size(); i++)
+    {
+        Upload(myPending[i]);
+        delete myPending[i].File;
+        myPending[i].File = NULL;
+    }
+    Debug("Textures: %u read and decoded in %.1f ms, waited %.1f ms, uploaded in %.1f ms",
+            (uint)myPending.size(), myDecodeTime * 1000,
+            (uploadStart - waitStart) * 1000, (Profiler::Now() - uploadStart) * 1000);
+    myPending.clear();
+}
+
+void TextureLoader::Release()
+{
+    for(uint i = 0; i < myPending.size(); i++)
+        delete myPending[i].File;
+    myPending.clear();
+}
+
+void TextureLoader::Upload(Pending &pending)
+{
+    // Only the base level goes to the engine, which keeps the binding and
+    // internal format to itself and builds the mip chain from it.
+    TextureSettings settings;
+    settings.MinFilter = GL_LINEAR_MIPMAP_LINEAR;
+    settings.MagFilter = GL_LINEAR;
+    settings.GenerateMipmap = true;
+    if(pending.File != NULL)
+    {
+        const TextureFile &file = *pending.File;
+        pending.Image->SetData(file.Width(), file.Height(), GL_BGRA, file.Level(0), settings);
+        return;
+    }
+    pending.Image->SetData(pending.Width, pending.Height, GL_BGRA,
+            &pending.Pixels[0], settings);
+    std::vector<unsigned char>().swap(pending.Pixels);
+}
@@ -0,0 +1,71 @@
+#ifndef TEXTURELOADER_H_
+#define TEXTURELOADER_H_
+
+#include <vector>
+#include <string>
+#include <pthread.h>
+#include "entity/Service.h"
+#include "assets/AssetManager.h"
+#include "assets/Texture.h"
+#include "TextureFile.h"
+
+using namespace anengine;
+
+/** Loads the startup textures on a pool of worker threads.
+ * A texture comes from its packed .gen.rtex copy when the assets build
+ * made one, from the bundle first and else from the file, already
+ * decoded; otherwise its PNG is decoded here. Either way only the base
+ * level is uploaded: the engine's Texture takes no mip levels, so it
+ * generates them. Start runs the reads and decodes in parallel while the
+ * rest of the startup goes on. Only the upload is left for the context
+ * thread: it happens when the service is initialized, so it must depend
+ * on the GL context and the scene on it. Prints the time of each phase.
+ */
+class TextureLoader : public Service
+{
+    static const uint MaxThreads = 4;
+
+    struct Pending
+    {
+        Asset<Texture> Image;
+        std::string Path;
+        TextureFile *File;
+        std::vector<unsigned char> Pixels;
+        uint Width;
+        uint Height;
+    };
+    std::vector<Pending> myPending;
+    pthread_mutex_t myLock;
+    pthread_t myThreads[MaxThreads];
+    uint myThreadCount;
+    uint myNext;
+    bool myStarted;
+    double myStartTime;
+    double myDecodeTime;
+
+    static void *sWorkerMain(void *loader);
+    void Work();
+    void Decode(Pending &pending);
+    void Wait();
+    void Upload(Pending &pending);
+    void Release();
+
+    protected:
+    virtual void OnInitialize();
+
+    public:
+    TextureLoader();
+    virtual ~TextureLoader();
+
+    /** The texture for the PNG at \a path, filled in once the service is
+     * initialized. Call before Start.
+     */
+    AssetRef<Texture> Load(AssetManager *manager, const char *path);
+
+    /** Starts reading and decoding every texture asked for. Done on
+     * initialization at the latest.
+     */
+    void Start();
+};
+
+#endif
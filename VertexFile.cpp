@@ -0,0 +1,116 @@
+#include "VertexFile.h"
+#include "AssetBundle.h"
+#include "core/Error.h"
+#include <cstring>
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+#include <unistd.h>
+
+namespace
+{
+    const size_t HeaderSize = 20;
+}
+
+VertexFile::VertexFile()
+    : myFile(NULL, 0), myData(NULL), myFloatCount(0)
+{
+}
+
+VertexFile::VertexFile(const char *path)
+    : myFile(path), myData(NULL), myFloatCount(0)
+{
+    if(myFile.Empty())
+    {
+        Debug("Failed to map %s", path);
+        throw Error(Error::InvalidValue, "Failed to map vertex file");
+    }
+    if(!Parse())
+    {
+        Debug("Not a binary vertex file: %s", path);
+        throw Error(Error::InvalidValue, "Not a binary vertex file");
+    }
+}
+
+VertexFile::VertexFile(const void *bytes, size_t size)
+    : myFile(bytes, size), myData(NULL), myFloatCount(0)
+{
+    if(!Parse())
+        throw Error(Error::InvalidValue, "Not a binary vertex file");
+}
+
+bool VertexFile::Parse()
+{
+    const unsigned char *bytes = myFile.Data();
+    size_t size = myFile.Size();
+    if(size < HeaderSize)
+        return false;
+    uint32_t layoutLength = MappedFile::ReadU32(bytes + 8);
+    myFloatCount = MappedFile::ReadU32(bytes + 12);
+    uint32_t dataOffset = MappedFile::ReadU32(bytes + 16);
+    if(memcmp(bytes, "VBOB", 4) != 0 || MappedFile::ReadU32(bytes + 4) != 1 ||
+            dataOffset % 16 != 0 || HeaderSize + layoutLength > dataOffset ||
+            dataOffset > size ||
+            myFloatCount > (size - dataOffset) / sizeof(float))
+        return false;
+    myLayout.assign(reinterpret_cast<const char*>(bytes + HeaderSize), layoutLength);
+    // Written little endian, which is what we run on.
+    myData = reinterpret_cast<const float*>(bytes + dataOffset);
+    return true;
+}
+
+VertexFile *VertexFile::Load(const char *path)
+{
+    std::string binary = BinaryPath(path);
+    const char *bundled;
+    size_t size;
+    if(AssetBundle::Default().Find(binary.c_str(), bundled, size))
+        return new VertexFile(bundled, size);
+    if(access(binary.c_str(), R_OK) == 0)
+        return new VertexFile(binary.c_str());
+
+    // Parse the text file if the assets build predates the binary one.
+    std::ifstream file(path);
+    std::string layout;
+    std::getline(file, layout);
+    std::istringstream header(layout);
+    std::string attributes;
+    header>>attributes;
+    if(!file || attributes.size() < 2 || attributes[0] != 'A')
+    {
+        Debug("Not a vertex file: %s", path);
+        throw Error(Error::InvalidValue, "Not a vertex file");
+    }
+    // Each attribute is name, type, normalized, stride and offset.
+    int attributeCount = atoi(attributes.c_str() + 1);
+    std::string skip;
+    for(int i = 0; i < attributeCount * 5; i++)
+        header>>skip;
+    uint buffers, count;
+    header>>buffers>>count;
+    std::vector<float> data(count);
+    for(uint i = 0; i < count; i++)
+        file>>data[i];
+    if(!header || !file)
+    {
+        Debug("Truncated vertex file: %s", path);
+        throw Error(Error::InvalidValue, "Truncated vertex file");
+    }
+    VertexFile *parsed = new VertexFile();
+    parsed->myLayout = layout;
+    parsed->myParsed.swap(data);
+    parsed->myData = parsed->myParsed.empty() ? NULL : &parsed->myParsed[0];
+    parsed->myFloatCount = count;
+    return parsed;
+}
+
+std::string VertexFile::BinaryPath(const char *path)
+{
+    std::string binary(path);
+    size_t dot = binary.rfind(".vbo");
+    if(dot != std::string::npos && dot + 4 == binary.size())
+        binary.replace(dot, 4, ".vbb");
+    else
+        binary += ".vbb";
+    return binary;
+}
@@ -0,0 +1,68 @@
+#ifndef VERTEXFILE_H_
+#define VERTEXFILE_H_
+
+#include <string>
+#include <vector>
+#include <cstddef>
+#include "MappedFile.h"
+
+using namespace anengine;
+
+/** Read only mapping of a binary vertex buffer, the .gen.vbb files the
+ * assets build writes next to each text .gen.vbo (see
+ * assets/generators/vbobin.c). The floats are used in place, already
+ * aligned for upload, and the pages are shared with the page cache.
+ * Only the viewer's own meshes read them; the entities that load a
+ * .gen.vbo through the engine's VertexBuffer loader still parse the text.
+ */
+class VertexFile
+{
+    MappedFile myFile;
+    const float *myData;
+    uint myFloatCount;
+    std::string myLayout;
+    std::vector<float> myParsed;
+
+    VertexFile();
+    VertexFile(const VertexFile &);
+    VertexFile &operator=(const VertexFile &);
+    bool Parse();
+
+    public:
+    /** Maps \a path, throws if it is not a binary vertex file.
+     */
+    VertexFile(const char *path);
+    /** Reads the \a size bytes at \a bytes, which must stay valid, as
+     * a binary vertex file. Throws if they are not one.
+     */
+    VertexFile(const void *bytes, size_t size);
+    ~VertexFile() { }
+
+    /** The vertex buffer file \a path, from the binary copy in the asset
+     * bundle or next to it if there is one, parsed from the text
+     * otherwise. Throws if neither can be read.
+     */
+    static VertexFile *Load(const char *path);
+
+    /** Name of the binary file written for the text file \a path.
+     */
+    static std::string BinaryPath(const char *path);
+
+    /** First line of the text file: the attributes, the buffer count and
+     * the float count.
+     */
+    const std::string &Layout() const
+    {
+        return myLayout;
+    }
+    const float *Data() const
+    {
+        return myData;
+    }
+    uint FloatCount() const
+    {
+        return myFloatCount;
+    }
+};
+
+#endif
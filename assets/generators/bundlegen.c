@@ -0,0 +1,110 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+
+/* Packs asset files into one bundle, the layout AssetBundle.cpp maps:
+ *   char magic[4]    "ABND"
+ *   uint32 version   1
+ *   uint32 count
+ *   uint32 reserved  0
+ *   entries[count]   char path[PathLength], zero padded,
+ *                    uint32 offset, uint32 size
+ *   file data, each file starting on a multiple of 16
+ * Integers are little endian. Entries are sorted by path, and a path is
+ * the prefix followed by the name given on the command line, the path the
+ * viewer asks for. The output only depends on the inputs.
+ */
+
+#define PathLength 56
+#define EntrySize (PathLength + 8)
+#define HeaderSize 16
+#define Alignment 16
+
+static void WriteU32(uint32_t value, FILE *file)
+{
+    unsigned char bytes[4] = { value, value >> 8, value >> 16, value >> 24 };
+    fwrite(bytes, 1, 4, file);
+}
+
+static uint32_t Align(uint32_t offset)
+{
+    return (offset + Alignment - 1) / Alignment * Alignment;
+}
+
+static int ComparePaths(const void *a, const void *b)
+{
+    return strcmp(*(char * const *)a, *(char * const *)b);
+}
+
+int main(int argc, char *argv[])
+{
+    if(argc < 4)
+    {
+        fprintf(stderr, "Usage: %s <output_file> <prefix> <file>...\n", argv[0]);
+        return 1;
+    }
+
+    const char *prefix = argv[2];
+    uint32_t count = argc - 3;
+    char **names = argv + 3;
+    qsort(names, count, sizeof(char*), ComparePaths);
+
+    uint32_t *sizes = calloc(count, sizeof(uint32_t));
+    uint32_t offset = Align(HeaderSize + count * EntrySize);
+    uint32_t i;
+    for(i = 0; i < count; i++)
+    {
+        if(strlen(prefix) + strlen(names[i]) >= PathLength)
+        {
+            fprintf(stderr, "Path too long: %s%s\n", prefix, names[i]);
+            return 1;
+        }
+        FILE *in = fopen(names[i], "rb");
+        if(!in)
+        {
+            fprintf(stderr, "Failed to open %s:", names[i]);
+            perror("");
+            return 1;
+        }
+        fseek(in, 0, SEEK_END);
+        sizes[i] = ftell(in);
+        fclose(in);
+    }
+
+    FILE *out = fopen(argv[1], "wb");
+    if(!out)
+    {
+        fprintf(stderr, "Failed to open %s:", argv[1]);
+        perror("");
+        return 1;
+    }
+    fwrite("ABND", 1, 4, out);
+    WriteU32(1, out);
+    WriteU32(count, out);
+    WriteU32(0, out);
+    for(i = 0; i < count; i++)
+    {
+        char path[PathLength] = {0};
+        strcpy(path, prefix);
+        strcat(path, names[i]);
+        fwrite(path, 1, PathLength, out);
+        WriteU32(offset, out);
+        WriteU32(sizes[i], out);
+        offset = Align(offset + sizes[i]);
+    }
+    for(i = 0; i < count; i++)
+    {
+        while(ftell(out) % Alignment != 0)
+            fputc(0, out);
+        FILE *in = fopen(names[i], "rb");
+        char buffer[4096];
+        size_t read;
+        while((read = fread(buffer, 1, sizeof(buffer), in)) > 0)
+            fwrite(buffer, 1, read, out);
+        fclose(in);
+    }
+    fclose(out);
+    free(sizes);
+    return 0;
+}
@@ -0,0 +1,115 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <SDL.h>
+#include "../../sndlib/sndbank.h"
+
+/* Converts the given WAV files to the mixer's output format and writes
+ * them into one sound bank, see sndlib/sndbank.h.
+ */
+
+static uint32_t Align(uint32_t offset)
+{
+    return (offset + SNDBANK_ALIGN - 1) / SNDBANK_ALIGN * SNDBANK_ALIGN;
+}
+
+static const char *BaseName(const char *path)
+{
+    const char *slash = strrchr(path, '/');
+    return slash ? slash + 1 : path;
+}
+
+/* Loads and converts one file, returns the PCM or NULL.
+ */
+static Uint8 *LoadSound(const char *path, uint32_t *length)
+{
+    SDL_AudioSpec spec;
+    Uint8 *data;
+    Uint32 size;
+    if(!SDL_LoadWAV(path, &spec, &data, &size))
+    {
+        fprintf(stderr, "Failed to load %s: %s\n", path, SDL_GetError());
+        return NULL;
+    }
+
+    SDL_AudioCVT cvt;
+    if(SDL_BuildAudioCVT(&cvt, spec.format, spec.channels, spec.freq,
+                SNDBANK_FORMAT, SNDBANK_CHANNELS, SNDBANK_FREQUENCY) < 0)
+    {
+        fprintf(stderr, "Can't convert %s: %s\n", path, SDL_GetError());
+        SDL_FreeWAV(data);
+        return NULL;
+    }
+    cvt.len = size;
+    cvt.buf = malloc(size * cvt.len_mult);
+    memcpy(cvt.buf, data, size);
+    SDL_FreeWAV(data);
+    if(SDL_ConvertAudio(&cvt) < 0)
+    {
+        fprintf(stderr, "Failed to convert %s: %s\n", path, SDL_GetError());
+        free(cvt.buf);
+        return NULL;
+    }
+    *length = cvt.len_cvt;
+    return cvt.buf;
+}
+
+int main(int argc, char *argv[])
+{
+    if(argc < 3)
+    {
+        fprintf(stderr, "Usage: %s <output_file> <wav_file>...\n", argv[0]);
+        return 1;
+    }
+
+    uint32_t count = argc - 2;
+    sndbank_header header;
+    memcpy(header.magic, SNDBANK_MAGIC, 4);
+    header.version = SNDBANK_VERSION;
+    header.frequency = SNDBANK_FREQUENCY;
+    header.format = SNDBANK_FORMAT;
+    header.channels = SNDBANK_CHANNELS;
+    header.count = count;
+
+    sndbank_entry *entries = calloc(count, sizeof(sndbank_entry));
+    Uint8 **sounds = calloc(count, sizeof(Uint8*));
+    uint32_t offset = Align(sizeof(sndbank_header) + count * sizeof(sndbank_entry));
+    uint32_t i;
+    for(i = 0; i < count; i++)
+    {
+        const char *path = argv[i + 2];
+        if(strlen(BaseName(path)) >= SNDBANK_NAME_LENGTH)
+        {
+            fprintf(stderr, "Name too long: %s\n", path);
+            return 1;
+        }
+        strncpy(entries[i].name, BaseName(path), SNDBANK_NAME_LENGTH);
+        sounds[i] = LoadSound(path, &entries[i].length);
+        if(!sounds[i])
+            return 1;
+        entries[i].offset = offset;
+        offset = Align(offset + entries[i].length);
+    }
+
+    FILE *file = fopen(argv[1], "wb");
+    if(!file)
+    {
+        fprintf(stderr, "Failed to open %s:", argv[1]);
+        perror("");
+        return 1;
+    }
+    fwrite(&header, sizeof(header), 1, file);
+    fwrite(entries, sizeof(sndbank_entry), count, file);
+    for(i = 0; i < count; i++)
+    {
+        static const char padding[SNDBANK_ALIGN] = {0};
+        long position = ftell(file);
+        fwrite(padding, 1, entries[i].offset - position, file);
+        fwrite(sounds[i], 1, entries[i].length, file);
+        free(sounds[i]);
+    }
+    fclose(file);
+    free(sounds);
+    free(entries);
+    return 0;
+}
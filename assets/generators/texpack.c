@@ -0,0 +1,139 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <png.h>
+
+/* Decodes a PNG and writes it with its whole mip chain, the layout
+ * TextureFile.cpp maps:
+ *   char magic[4]    "RTEX"
+ *   uint32 version   1
+ *   uint32 width
+ *   uint32 height
+ *   uint32 levels    down to 1x1
+ *   uint32 reserved  0
+ *   levels * { uint32 offset, uint32 size }
+ *   pixel data, each level starting on a multiple of 16
+ * Integers are little endian. Pixels are 8 bit BGRA, the format the viewer
+ * uploads, rows in the order of the PNG. Each level is the 2x2 box filter
+ * of the one above, clamped at odd edges.
+ */
+
+#define HeaderSize 24
+#define Alignment 16
+
+static void WriteU32(uint32_t value, FILE *file)
+{
+    unsigned char bytes[4] = { value, value >> 8, value >> 16, value >> 24 };
+    fwrite(bytes, 1, 4, file);
+}
+
+static uint32_t Align(uint32_t offset)
+{
+    return (offset + Alignment - 1) / Alignment * Alignment;
+}
+
+static uint32_t Half(uint32_t size)
+{
+    return size > 1 ? size / 2 : 1;
+}
+
+static unsigned char *Downsample(const unsigned char *in, uint32_t width, uint32_t height)
+{
+    uint32_t outWidth = Half(width);
+    uint32_t outHeight = Half(height);
+    unsigned char *out = malloc(outWidth * outHeight * 4);
+    uint32_t x, y, c;
+    for(y = 0; y < outHeight; y++)
+    {
+        uint32_t y0 = y * 2 < height ? y * 2 : height - 1;
+        uint32_t y1 = y * 2 + 1 < height ? y * 2 + 1 : height - 1;
+        for(x = 0; x < outWidth; x++)
+        {
+            uint32_t x0 = x * 2 < width ? x * 2 : width - 1;
+            uint32_t x1 = x * 2 + 1 < width ? x * 2 + 1 : width - 1;
+            for(c = 0; c < 4; c++)
+            {
+                uint32_t sum = in[(y0 * width + x0) * 4 + c] + in[(y0 * width + x1) * 4 + c] +
+                    in[(y1 * width + x0) * 4 + c] + in[(y1 * width + x1) * 4 + c];
+                out[(y * outWidth + x) * 4 + c] = (sum + 2) / 4;
+            }
+        }
+    }
+    return out;
+}
+
+int main(int argc, char *argv[])
+{
+    if(argc != 3)
+    {
+        fprintf(stderr, "Usage: %s <png_file> <output_file>\n", argv[0]);
+        return 1;
+    }
+
+    png_image image;
+    memset(&image, 0, sizeof(image));
+    image.version = PNG_IMAGE_VERSION;
+    if(!png_image_begin_read_from_file(&image, argv[1]))
+    {
+        fprintf(stderr, "Failed to read %s: %s\n", argv[1], image.message);
+        return 1;
+    }
+    image.format = PNG_FORMAT_BGRA;
+    unsigned char *pixels = malloc(PNG_IMAGE_SIZE(image));
+    if(!png_image_finish_read(&image, NULL, pixels, 0, NULL))
+    {
+        fprintf(stderr, "Failed to decode %s: %s\n", argv[1], image.message);
+        return 1;
+    }
+
+    uint32_t width = image.width;
+    uint32_t height = image.height;
+    uint32_t levels = 1;
+    while(width >> levels || height >> levels)
+        levels++;
+
+    FILE *out = fopen(argv[2], "wb");
+    if(!out)
+    {
+        fprintf(stderr, "Failed to open %s:", argv[2]);
+        perror("");
+        return 1;
+    }
+    fwrite("RTEX", 1, 4, out);
+    WriteU32(1, out);
+    WriteU32(width, out);
+    WriteU32(height, out);
+    WriteU32(levels, out);
+    WriteU32(0, out);
+    uint32_t offset = Align(HeaderSize + levels * 8);
+    uint32_t w = width, h = height, i;
+    for(i = 0; i < levels; i++)
+    {
+        WriteU32(offset, out);
+        WriteU32(w * h * 4, out);
+        offset = Align(offset + w * h * 4);
+        w = Half(w);
+        h = Half(h);
+    }
+
+    w = width;
+    h = height;
+    for(i = 0; i < levels; i++)
+    {
+        while(ftell(out) % Alignment != 0)
+            fputc(0, out);
+        fwrite(pixels, 4, w * h, out);
+        if(i + 1 < levels)
+        {
+            unsigned char *next = Downsample(pixels, w, h);
+            free(pixels);
+            pixels = next;
+            w = Half(w);
+            h = Half(h);
+        }
+    }
+    free(pixels);
+    fclose(out);
+    return 0;
+}
@@ -0,0 +1,97 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+
+/* Writes the binary copy of a text vertex buffer written by the other
+ * generators, the layout VertexFile.cpp maps:
+ *   char magic[4]       "VBOB"
+ *   uint32 version      1
+ *   uint32 layoutLength bytes of the layout text
+ *   uint32 floatCount
+ *   uint32 dataOffset   multiple of 16
+ *   layout text         the first line of the text file, zero padded
+ *   float data[floatCount]
+ * Integers and floats are little endian. The floats are the values of the
+ * text file, and nothing else goes in, so the output only depends on it.
+ */
+
+#define Alignment 16
+
+static void WriteU32(uint32_t value, FILE *file)
+{
+    unsigned char bytes[4] = { value, value >> 8, value >> 16, value >> 24 };
+    fwrite(bytes, 1, 4, file);
+}
+
+int main(int argc, char *argv[])
+{
+    if(argc != 3)
+    {
+        fprintf(stderr, "Usage: %s <text_vbo> <output_file>\n", argv[0]);
+        return 1;
+    }
+
+    FILE *in = fopen(argv[1], "r");
+    if(!in)
+    {
+        fprintf(stderr, "Failed to open %s:", argv[1]);
+        perror("");
+        return 1;
+    }
+    char layout[1024];
+    if(!fgets(layout, sizeof(layout), in) || layout[0] != 'A')
+    {
+        fprintf(stderr, "Not a vertex file: %s\n", argv[1]);
+        return 1;
+    }
+    layout[strcspn(layout, "\r\n")] = '\0';
+
+    /* The layout ends with the buffer count and the float count. */
+    const char *count = strrchr(layout, ' ');
+    if(!count)
+    {
+        fprintf(stderr, "Bad layout in %s\n", argv[1]);
+        return 1;
+    }
+    uint32_t floatCount = strtoul(count + 1, NULL, 10);
+    float *data = malloc(floatCount * sizeof(float) + 1);
+    uint32_t i;
+    for(i = 0; i < floatCount; i++)
+    {
+        if(fscanf(in, "%f", &data[i]) != 1)
+        {
+            fprintf(stderr, "Truncated vertex file: %s\n", argv[1]);
+            return 1;
+        }
+    }
+    fclose(in);
+
+    uint32_t layoutLength = strlen(layout);
+    uint32_t dataOffset = (20 + layoutLength + Alignment - 1) / Alignment * Alignment;
+
+    FILE *out = fopen(argv[2], "wb");
+    if(!out)
+    {
+        fprintf(stderr, "Failed to open %s:", argv[2]);
+        perror("");
+        return 1;
+    }
+    fwrite("VBOB", 1, 4, out);
+    WriteU32(1, out);
+    WriteU32(layoutLength, out);
+    WriteU32(floatCount, out);
+    WriteU32(dataOffset, out);
+    fwrite(layout, 1, layoutLength, out);
+    for(i = 20 + layoutLength; i < dataOffset; i++)
+        fputc(0, out);
+    for(i = 0; i < floatCount; i++)
+    {
+        uint32_t bits;
+        memcpy(&bits, &data[i], 4);
+        WriteU32(bits, out);
+    }
+    fclose(out);
+    free(data);
+    return 0;
+}
@@ -0,0 +1,46 @@
+#ifndef SNDBANK_H_
+#define SNDBANK_H_
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+  /**
+   * Sound bank layout, written by assets/generators/soundbankgen.c
+   * and mapped by sndlib. All fields are little endian:
+   *   sndbank_header
+   *   sndbank_entry[count]
+   *   PCM data, each sound starting on a SNDBANK_ALIGN boundary
+   * The PCM is already in the mixer's output format, so sndlib
+   * plays it straight from the mapping.
+   */
+#define SNDBANK_MAGIC "SNDB"
+#define SNDBANK_VERSION 1
+#define SNDBANK_NAME_LENGTH 32
+#define SNDBANK_ALIGN 16
+
+#define SNDBANK_FREQUENCY 22050
+#define SNDBANK_FORMAT 0x8010 // AUDIO_S16LSB
+#define SNDBANK_CHANNELS 2
+
+  typedef struct {
+    char magic[4];
+    uint32_t version;
+    uint32_t frequency;
+    uint16_t format;
+    uint16_t channels;
+    uint32_t count;
+  } sndbank_header;
+
+  typedef struct {
+    char name[SNDBANK_NAME_LENGTH]; // file name of the source, zero padded
+    uint32_t offset; // from the start of the bank
+    uint32_t length; // in bytes
+  } sndbank_entry;
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
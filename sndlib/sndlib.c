@@ -1,3 +1,4 @@
+#define _POSIX_C_SOURCE 200112L
 #include "sndlib.h"
 #include <assert.h>
 
@@ -6,83 +7,538 @@
 #ifndef NO_SNDLIB
 // Sound is globally enabled.
 
-static Mix_Chunk *snd_wind;
-static Mix_Chunk *snd_laser;
-static Mix_Chunk *snd_steps;
-static Mix_Chunk *snd_mortar_shot;
-static Mix_Chunk *snd_mortar_hit;
-static Mix_Chunk *snd_robot_destruction;
-static Mix_Chunk *snd_robot_mining;
+#include <pthread.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <stdlib.h>
+#include "sndbank.h"
 
+#define SNDLIB_LOADER_THREADS 4
+#define SNDLIB_WIND_CHANNEL 0
+
+// Samples found in the sound bank are ready at once, the others are
+// decoded on loader threads while the game starts. A sample
+// plays once it is loaded; one-shot sounds asked for before that are
+// dropped and counted, the looping wind is started by its loader.
+enum {
+  SND_WIND,
+  SND_LASER,
+  SND_STEPS,
+  SND_MORTAR_SHOT,
+  SND_MORTAR_HIT,
+  SND_ROBOT_DESTRUCTION,
+  SND_ROBOT_MINING,
+  SND_COUNT
+};
+
+// Higher priorities take the voice of lower ones when all are busy.
+static const int sample_priority[SND_COUNT] = {
+  0, // wind, has its own channel
+  2, // laser
+  0, // steps
+  2, // mortar shot
+  3, // mortar hit
+  4, // robot destruction
+  1  // robot mining
+};
+
+static const char *sample_files[SND_COUNT] = {
+  SNDLIB_SOUND_WIND,
+  SNDLIB_SOUND_LASER,
+  SNDLIB_SOUND_ROBOT_MOVEMENT,
+  SNDLIB_SOUND_MORTAR_FIRE,
+  SNDLIB_SOUND_MORTAR_IMPACT,
+  SNDLIB_SOUND_ROBOT_DESTRUCTION,
+  SNDLIB_SOUND_ROBOT_MINING
+};
+
+static pthread_mutex_t sample_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_t loaders[SNDLIB_LOADER_THREADS];
+static int loader_count;
+static int next_sample;
+static int sample_done[SND_COUNT];
+static Mix_Chunk *samples[SND_COUNT];
+static int wind_deferred;
+static unsigned int dropped;
+// Priority and start order of the sound on each effect channel.
+static int voice_priority[SNDLIB_VOICES];
+static unsigned int voice_started[SNDLIB_VOICES];
+static unsigned int voice_counter;
+static unsigned int stolen;
+// The mapped sound bank, samples found in it play straight from its pages.
+static void *bank;
+static size_t bank_size;
+
+// Offline backends: plays are recorded instead of mixed, the WAV writer
+// mixes them into its file when sndlib quits.
+static int backend = SNDLIB_BACKEND_MIXER;
+static const char *backend_path;
+static struct timespec start_time;
+static sndlib_event *events;
+static unsigned int event_count;
+static unsigned int event_capacity;
+static Uint8 *offline_pcm[SND_COUNT];
+static Uint32 offline_length[SND_COUNT];
+
+
+void *_sndlib_loader_main(void *unused);
+void *_sndlib_loader_main(void *unused){
+  (void)unused;
+  pthread_mutex_lock(&sample_lock);
+  while(next_sample < SND_COUNT){
+    int sample = next_sample++;
+    if(sample_done[sample])
+      continue;
+    pthread_mutex_unlock(&sample_lock);
+    Mix_Chunk *chunk = Mix_LoadWAV(sample_files[sample]);
+    if(chunk == NULL)
+      printf("sndlib.c: failed to load %s: %s\n", sample_files[sample], Mix_GetError());
+    pthread_mutex_lock(&sample_lock);
+    samples[sample] = chunk;
+    sample_done[sample] = 1;
+    if(sample == SND_WIND && wind_deferred && chunk != NULL){
+      wind_deferred = 0;
+      Mix_PlayChannel(SNDLIB_WIND_CHANNEL, chunk, -1);
+    }
+  }
+  pthread_mutex_unlock(&sample_lock);
+  return NULL;
+}
+
+void _sndlib_map_bank(void);
+void _sndlib_map_bank(void){
+  int fd = open(SNDLIB_SOUND_BANK, O_RDONLY);
+  if(fd == -1)
+    return; // no bank, decode the WAV files
+  struct stat st;
+  if(fstat(fd, &st) == 0 && (size_t)st.st_size >= sizeof(sndbank_header)){
+    void *map = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    if(map != MAP_FAILED){
+      bank = map;
+      bank_size = (size_t)st.st_size;
+    }
+  }
+  close(fd);
+  if(bank == NULL)
+    return;
+
+  const sndbank_header *header = bank;
+  int frequency, channels;
+  Uint16 format;
+  Mix_QuerySpec(&frequency, &format, &channels);
+  if(memcmp(header->magic, SNDBANK_MAGIC, 4) != 0 || header->version != SNDBANK_VERSION
+     || header->frequency != (uint32_t)frequency || header->format != format
+     || header->channels != (uint16_t)channels
+     || header->count > (bank_size - sizeof(sndbank_header)) / sizeof(sndbank_entry)){
+    printf("sndlib.c: %s does not match the mixer, decoding the WAV files instead.\n", SNDLIB_SOUND_BANK);
+    munmap(bank, bank_size);
+    bank = NULL;
+    return;
+  }
+  const sndbank_entry *entries = (const sndbank_entry *)(header + 1);
+  for(int i = 0; i < SND_COUNT; i++){
+    const char *name = strrchr(sample_files[i], '/');
+    name = name != NULL ? name + 1 : sample_files[i];
+    for(uint32_t j = 0; j < header->count; j++){
+      if(strncmp(entries[j].name, name, SNDBANK_NAME_LENGTH) != 0)
+        continue;
+      if(entries[j].offset <= bank_size && entries[j].length <= bank_size - entries[j].offset){
+        // The mixer only reads chunk data, so the pages stay clean and shared.
+        samples[i] = Mix_QuickLoad_RAW((Uint8 *)bank + entries[j].offset, entries[j].length);
+        sample_done[i] = samples[i] != NULL;
+      }
+      break;
+    }
+  }
+}
 
 void _sndlib_load_samples(void);
 void _sndlib_load_samples(void){
-  snd_wind = Mix_LoadWAV(SNDLIB_SOUND_WIND);
-  snd_laser = Mix_LoadWAV(SNDLIB_SOUND_LASER);
-  snd_steps = Mix_LoadWAV(SNDLIB_SOUND_ROBOT_MOVEMENT);
-  snd_mortar_shot = Mix_LoadWAV(SNDLIB_SOUND_MORTAR_FIRE);
-  snd_mortar_hit = Mix_LoadWAV(SNDLIB_SOUND_MORTAR_IMPACT);
-  snd_robot_destruction = Mix_LoadWAV(SNDLIB_SOUND_ROBOT_DESTRUCTION);
-  snd_robot_mining = Mix_LoadWAV(SNDLIB_SOUND_ROBOT_MINING);
-  assert(snd_wind != NULL);
-  assert(snd_laser != NULL);
-  assert(snd_steps != NULL);
-  assert(snd_mortar_shot != NULL);
-  assert(snd_mortar_hit != NULL);
-  assert(snd_robot_destruction != NULL);
-  Mix_Volume(-1, 8);
+  next_sample = 0;
+  wind_deferred = 0;
+  dropped = 0;
+  stolen = 0;
+  for(int i = 0; i < SND_COUNT; i++){
+    samples[i] = NULL;
+    sample_done[i] = 0;
+  }
+  _sndlib_map_bank();
+  for(loader_count = 0; loader_count < SNDLIB_LOADER_THREADS && loader_count < SND_COUNT; loader_count++){
+    if(pthread_create(&loaders[loader_count], NULL, _sndlib_loader_main, NULL) != 0)
+      break;
+  }
+  // Without any thread, load everything here like before.
+  if(loader_count == 0)
+    _sndlib_loader_main(NULL);
+}
+
+// The sample if it is loaded, NULL and the request counted as dropped if not.
+static Mix_Chunk *_sndlib_sample(int sample){
+  pthread_mutex_lock(&sample_lock);
+  Mix_Chunk *chunk = samples[sample];
+  if(chunk == NULL)
+    dropped++;
+  pthread_mutex_unlock(&sample_lock);
+  return chunk;
+}
+
+static const char *_sndlib_sample_name(int sample){
+  const char *name = strrchr(sample_files[sample], '/');
+  return name != NULL ? name + 1 : sample_files[sample];
+}
+
+static double _sndlib_time(void){
+  struct timespec now;
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  return (double)(now.tv_sec - start_time.tv_sec) + (double)(now.tv_nsec - start_time.tv_nsec) * 1e-9;
+}
+
+// Adds a play of the sound in file to the event list, duration in
+// seconds, 0 for the whole sample, -1 until stopped.
+static void _sndlib_record_file(const char *file, double duration){
+  const char *name = strrchr(file, '/');
+  pthread_mutex_lock(&sample_lock);
+  if(event_count == event_capacity){
+    event_capacity = event_capacity ? event_capacity * 2 : 256;
+    events = realloc(events, event_capacity * sizeof(sndlib_event));
+  }
+  events[event_count].time = _sndlib_time();
+  events[event_count].sound = name != NULL ? name + 1 : file;
+  events[event_count].duration = duration;
+  event_count++;
+  pthread_mutex_unlock(&sample_lock);
+}
+
+static void _sndlib_record(int sample, double duration){
+  _sndlib_record_file(sample_files[sample], duration);
+}
+
+// Sounds without a sample are still recorded by the offline backends,
+// so the log has every play asked for. The WAV writer skips them.
+static void _sndlib_record_missing(const char *file, int ticks){
+  if(backend != SNDLIB_BACKEND_MIXER)
+    _sndlib_record_file(file, ticks < 0 ? 0 : ticks / 1000.0);
+}
+
+// Decodes the samples for the WAV writer, converted like the mixer would.
+static void _sndlib_load_offline(void){
+  for(int i = 0; i < SND_COUNT; i++){
+    SDL_AudioSpec spec;
+    Uint8 *data;
+    Uint32 size;
+    offline_pcm[i] = NULL;
+    offline_length[i] = 0;
+    if(SDL_LoadWAV(sample_files[i], &spec, &data, &size) == NULL){
+      printf("sndlib.c: failed to load %s: %s\n", sample_files[i], SDL_GetError());
+      continue;
+    }
+    SDL_AudioCVT cvt;
+    if(SDL_BuildAudioCVT(&cvt, spec.format, spec.channels, spec.freq,
+                         AUDIO_S16, 2, SNDLIB_OFFLINE_FREQUENCY) < 0){
+      SDL_FreeWAV(data);
+      continue;
+    }
+    cvt.len = (int)size;
+    cvt.buf = malloc(size * (Uint32)cvt.len_mult);
+    memcpy(cvt.buf, data, size);
+    SDL_FreeWAV(data);
+    if(SDL_ConvertAudio(&cvt) < 0){
+      free(cvt.buf);
+      continue;
+    }
+    offline_pcm[i] = cvt.buf;
+    offline_length[i] = (Uint32)cvt.len_cvt;
+  }
+}
+
+static int _sndlib_sample_by_name(const char *name){
+  for(int i = 0; i < SND_COUNT; i++)
+    if(strcmp(_sndlib_sample_name(i), name) == 0)
+      return i;
+  return -1;
+}
+
+static void _sndlib_write_u32(FILE *file, Uint32 value){
+  Uint8 bytes[4] = { (Uint8)value, (Uint8)(value >> 8), (Uint8)(value >> 16), (Uint8)(value >> 24) };
+  fwrite(bytes, 1, 4, file);
+}
+
+static void _sndlib_write_u16(FILE *file, Uint16 value){
+  Uint8 bytes[2] = { (Uint8)value, (Uint8)(value >> 8) };
+  fwrite(bytes, 1, 2, file);
+}
+
+// Mixes the recorded plays like the mixer would, at volume 8 of 128,
+// and writes them as a 16 bit stereo WAV file.
+static void _sndlib_write_wav(double end){
+  struct timespec mix_start, mix_end;
+  clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &mix_start);
+  Uint32 frames = (Uint32)(end * SNDLIB_OFFLINE_FREQUENCY) + 1;
+  int *mix = calloc((size_t)frames * 2, sizeof(int));
+  for(unsigned int e = 0; e < event_count; e++){
+    int sample = _sndlib_sample_by_name(events[e].sound);
+    if(sample == -1 || offline_pcm[sample] == NULL)
+      continue;
+    const Sint16 *pcm = (const Sint16 *)offline_pcm[sample];
+    Uint32 pcm_frames = offline_length[sample] / 4;
+    if(pcm_frames == 0)
+      continue;
+    Uint32 first = (Uint32)(events[e].time * SNDLIB_OFFLINE_FREQUENCY);
+    Uint32 count = pcm_frames;
+    if(events[e].duration < 0)
+      count = frames; // looping, cut at the end
+    else if(events[e].duration > 0 && (Uint32)(events[e].duration * SNDLIB_OFFLINE_FREQUENCY) < count)
+      count = (Uint32)(events[e].duration * SNDLIB_OFFLINE_FREQUENCY);
+    for(Uint32 f = 0; f < count && first + f < frames; f++){
+      Uint32 source = (f % pcm_frames) * 2;
+      mix[(first + f) * 2] += pcm[source] * 8 / 128;
+      mix[(first + f) * 2 + 1] += pcm[source + 1] * 8 / 128;
+    }
+  }
+  Sint16 *out = malloc((size_t)frames * 2 * sizeof(Sint16));
+  for(Uint32 i = 0; i < frames * 2; i++)
+    out[i] = (Sint16)(mix[i] > 32767 ? 32767 : mix[i] < -32768 ? -32768 : mix[i]);
+  free(mix);
+  clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &mix_end);
+  printf("sndlib.c: mixed %u sounds, %.1f s of audio in %.3f ms\n", event_count, end,
+         (double)(mix_end.tv_sec - mix_start.tv_sec) * 1e3 + (double)(mix_end.tv_nsec - mix_start.tv_nsec) * 1e-6);
+
+  FILE *file = fopen(backend_path, "wb");
+  if(file == NULL){
+    printf("sndlib.c: failed to open %s\n", backend_path);
+    free(out);
+    return;
+  }
+  Uint32 bytes = frames * 4;
+  fwrite("RIFF", 1, 4, file);
+  _sndlib_write_u32(file, 36 + bytes);
+  fwrite("WAVEfmt ", 1, 8, file);
+  _sndlib_write_u32(file, 16);
+  _sndlib_write_u16(file, 1); // PCM
+  _sndlib_write_u16(file, 2);
+  _sndlib_write_u32(file, SNDLIB_OFFLINE_FREQUENCY);
+  _sndlib_write_u32(file, SNDLIB_OFFLINE_FREQUENCY * 4);
+  _sndlib_write_u16(file, 4);
+  _sndlib_write_u16(file, 16);
+  fwrite("data", 1, 4, file);
+  _sndlib_write_u32(file, bytes);
+  fwrite(out, sizeof(Sint16), (size_t)frames * 2, file); // host is little endian
+  fclose(file);
+  free(out);
+}
+
+static void _sndlib_write_log(void){
+  FILE *file = fopen(backend_path, "w");
+  if(file == NULL){
+    printf("sndlib.c: failed to open %s\n", backend_path);
+    return;
+  }
+  for(unsigned int i = 0; i < event_count; i++)
+    fprintf(file, "%.6f %s %.6f\n", events[i].time, events[i].sound, events[i].duration);
+  fclose(file);
+}
+
+static void _sndlib_quit_offline(void){
+  double end = _sndlib_time();
+  sndlib_stop_wind();
+  if(backend_path != NULL){
+    if(backend == SNDLIB_BACKEND_WAV)
+      _sndlib_write_wav(end);
+    else
+      _sndlib_write_log();
+  }
+  for(int i = 0; i < SND_COUNT; i++){
+    free(offline_pcm[i]);
+    offline_pcm[i] = NULL;
+  }
+  free(events);
+  events = NULL;
+  event_count = event_capacity = 0;
+}
+
+/**
+ * Plays a sample on a free effect channel. With none free the oldest of
+ * the lowest priority sounds is cut off, unless the new one ranks lower
+ * still, then it is dropped.
+ */
+static void _sndlib_play(int sample, int ticks){
+  if(backend != SNDLIB_BACKEND_MIXER){
+    _sndlib_record(sample, ticks < 0 ? 0 : ticks / 1000.0);
+    return;
+  }
+  Mix_Chunk *chunk = _sndlib_sample(sample);
+  if(chunk == NULL)
+    return;
+  int priority = sample_priority[sample];
+  int channel = -1;
+  for(int i = SNDLIB_WIND_CHANNEL + 1; i < SNDLIB_VOICES; i++){
+    if(!Mix_Playing(i)){
+      channel = i;
+      break;
+    }
+    if(channel == -1 || voice_priority[i] < voice_priority[channel]
+       || (voice_priority[i] == voice_priority[channel]
+           && voice_started[i] < voice_started[channel]))
+      channel = i;
+  }
+  if(channel == -1)
+    return;
+  if(Mix_Playing(channel)){
+    if(voice_priority[channel] > priority){
+      pthread_mutex_lock(&sample_lock);
+      dropped++;
+      pthread_mutex_unlock(&sample_lock);
+      return;
+    }
+    Mix_HaltChannel(channel);
+    stolen++;
+  }
+  voice_priority[channel] = priority;
+  voice_started[channel] = voice_counter++;
+  Mix_PlayChannelTimed(channel, chunk, 0, ticks);
+}
+
+void sndlib_set_backend(int new_backend, const char *path){
+  backend = new_backend;
+  backend_path = path;
+}
+
+const sndlib_event *sndlib_get_events(unsigned int *count){
+  *count = event_count;
+  return events;
 }
 
 void sndlib_init(void){
+  clock_gettime(CLOCK_MONOTONIC, &start_time);
+  if(backend != SNDLIB_BACKEND_MIXER){
+    if(backend == SNDLIB_BACKEND_WAV)
+      _sndlib_load_offline();
+    return;
+  }
   assert(SDL_Init(SDL_INIT_AUDIO) != -1);
   assert(Mix_OpenAudio(22050, AUDIO_S16, 2, 4096) != -1);
+  Mix_AllocateChannels(SNDLIB_VOICES);
+  Mix_ReserveChannels(SNDLIB_WIND_CHANNEL + 1);
+  Mix_Volume(-1, 8);
   _sndlib_load_samples();
 }
+
+void sndlib_wait_loaded(void){
+  for(int i = 0; i < loader_count; i++)
+    pthread_join(loaders[i], NULL);
+  loader_count = 0;
+}
+
+unsigned int sndlib_loaded_count(void){
+  unsigned int count = 0;
+  pthread_mutex_lock(&sample_lock);
+  for(int i = 0; i < SND_COUNT; i++)
+    if(samples[i] != NULL)
+      count++;
+  pthread_mutex_unlock(&sample_lock);
+  return count;
+}
+
+unsigned int sndlib_stolen_count(void){
+  return stolen;
+}
+
+unsigned int sndlib_dropped_count(void){
+  pthread_mutex_lock(&sample_lock);
+  unsigned int count = dropped;
+  pthread_mutex_unlock(&sample_lock);
+  return count;
+}
+
 void sndlib_quit(void){
+  if(backend != SNDLIB_BACKEND_MIXER){
+    _sndlib_quit_offline();
+    return;
+  }
+  sndlib_wait_loaded();
+  Mix_HaltChannel(-1);
+  for(int i = 0; i < SND_COUNT; i++){
+    if(samples[i] != NULL)
+      Mix_FreeChunk(samples[i]);
+    samples[i] = NULL;
+  }
   Mix_CloseAudio();
+  if(bank != NULL)
+    munmap(bank, bank_size);
+  bank = NULL;
 }
 
 void sndlib_play_wind(void){
-  assert(Mix_PlayChannel(-1, snd_wind, -1) != -1);
+  if(backend != SNDLIB_BACKEND_MIXER){
+    _sndlib_record(SND_WIND, -1);
+    return;
+  }
+  pthread_mutex_lock(&sample_lock);
+  if(samples[SND_WIND] != NULL)
+    Mix_PlayChannel(SNDLIB_WIND_CHANNEL, samples[SND_WIND], -1);
+  else if(!sample_done[SND_WIND])
+    wind_deferred = 1;
+  pthread_mutex_unlock(&sample_lock);
   //Mix_PlayMusic(snd_wind, 0);
 }
 
 void sndlib_stop_wind(void){
-  SNDLIB_STUB("register globals yada yada");
+  if(backend != SNDLIB_BACKEND_MIXER){
+    // End the running wind where it stops.
+    pthread_mutex_lock(&sample_lock);
+    for(unsigned int i = 0; i < event_count; i++)
+      if(events[i].duration < 0 && events[i].sound == _sndlib_sample_name(SND_WIND))
+        events[i].duration = _sndlib_time() - events[i].time;
+    pthread_mutex_unlock(&sample_lock);
+    return;
+  }
+  pthread_mutex_lock(&sample_lock);
+  wind_deferred = 0;
+  pthread_mutex_unlock(&sample_lock);
+  Mix_HaltChannel(SNDLIB_WIND_CHANNEL);
 }
 
 void sndlib_play_laser(int milliseconds){
-  Mix_PlayChannelTimed(-1, snd_laser, 0, milliseconds);
+  _sndlib_play(SND_LASER, milliseconds);
   //Mix_PlayMusic(snd_laser, 0);
 }
 
 void sndlib_play_mortar_fire(void){
   //int Mix_PlayChannel(int channel, Mix_Chunk *chunk, int loops)
-  Mix_PlayChannel(-1, snd_mortar_shot, 0);
+  _sndlib_play(SND_MORTAR_SHOT, -1);
 }
 void sndlib_play_mortar_air(int milliseconds){
+  _sndlib_record_missing(SNDLIB_SOUND_MORTAR_AIR, milliseconds);
   SNDLIB_STUB("add sound");
 }
 void sndlib_play_mortar_impact(void){
-  Mix_PlayChannel(-1, snd_mortar_hit, 0);
+  _sndlib_play(SND_MORTAR_HIT, -1);
 }
 void sndlib_play_droid_fire(void){
+  _sndlib_record_missing(SNDLIB_SOUND_DROID_LAUNCH, -1);
   SNDLIB_STUB("add sound");
 }
 void sndlib_play_droid_step(void){
+  _sndlib_record_missing(SNDLIB_SOUND_DROID_STEP, -1);
   SNDLIB_STUB("add sound");
 }
 void sndlib_play_droid_impact(void){
-  Mix_PlayChannel(-1, snd_mortar_hit, 0);
+  _sndlib_play(SND_MORTAR_HIT, -1);
 }
 void sndlib_play_robot_destruction(void){
-  Mix_PlayChannel(-1, snd_robot_destruction, 0);
+  _sndlib_play(SND_ROBOT_DESTRUCTION, -1);
 }
 void sndlib_play_robot_respawn(void){
+  // No file for it yet, recorded under the name it would have.
+  _sndlib_record_missing(SNDLIB_SOUND_DIR "/" "robot-respawn.wav", -1);
   SNDLIB_STUB("add sound");
 }
 void sndlib_play_robot_mining(void){
-  Mix_PlayChannel(-1, snd_robot_mining, 0);
+  _sndlib_play(SND_ROBOT_MINING, -1);
 }
 
 #else
@@ -91,6 +547,12 @@ void sndlib_play_robot_mining(void){
 void sndlib_init(void){
   printf("sndlib.c: Compiled with -DNO_SNDLIB set, won't play any sound or load any files.\n");
 }
+void sndlib_set_backend(int new_backend, const char *path){}
+const sndlib_event *sndlib_get_events(unsigned int *count){ *count = 0; return NULL; }
+void sndlib_wait_loaded(void){}
+unsigned int sndlib_loaded_count(void){ return 0; }
+unsigned int sndlib_dropped_count(void){ return 0; }
+unsigned int sndlib_stolen_count(void){ return 0; }
 void sndlib_quit(void){}
 void sndlib_play_wind(void){}
 void sndlib_stop_wind(void){}
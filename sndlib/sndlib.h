@@ -10,6 +10,19 @@ extern "C" {
 #ifndef SNDLIB_SOUND_DIR
 #define SNDLIB_SOUND_DIR "."
 #endif
+
+/* Where sndlib_init sends the sounds, see sndlib_set_backend. */
+#define SNDLIB_BACKEND_MIXER 0
+#define SNDLIB_BACKEND_NULL 1
+#define SNDLIB_BACKEND_WAV 2
+
+/* Sample rate of the WAV writer's output. */
+#define SNDLIB_OFFLINE_FREQUENCY 22050
+
+/* Mixer channels: one for the wind, the rest are shared by the effects. */
+#ifndef SNDLIB_VOICES
+#define SNDLIB_VOICES 8
+#endif
   
 #define SNDLIB_SOUND_WIND SNDLIB_SOUND_DIR "/" "wind.wav"
   
@@ -27,15 +40,88 @@ extern "C" {
 #define SNDLIB_SOUND_ROBOT_MOVEMENT SNDLIB_SOUND_DIR "/" "robot-movement.wav"
 #define SNDLIB_SOUND_ROBOT_MINING SNDLIB_SOUND_DIR "/" "robot-mining.wav"
 
+/* Pre-converted copy of the sounds above, see sndbank.h. Sounds found in
+ * it are used from it, the others are decoded from their WAV file. */
+#define SNDLIB_SOUND_BANK SNDLIB_SOUND_DIR "/" "sounds.gen.bank"
+
   
   /**
-   * Initialize the sound library and load & decode
-   * all sounds from disk. May take a while.
+   * A play recorded by the null and WAV backends.
+   * time: seconds since sndlib_init.
+   * sound: file name of the sound.
+   * duration: seconds, 0 for the whole sound,
+   *           -1 for the wind while it is playing.
+   */
+  typedef struct {
+    double time;
+    const char *sound;
+    double duration;
+  } sndlib_event;
+
+
+  /**
+   * Choose the backend, before sndlib_init.
+   * SNDLIB_BACKEND_MIXER: play through SDL_mixer,
+   *   the default. path is unused.
+   * SNDLIB_BACKEND_NULL: open no audio device and
+   *   only record the plays. sndlib_quit writes
+   *   them to path, if not NULL, one per line as
+   *   "time sound duration".
+   * SNDLIB_BACKEND_WAV: like NULL, and sndlib_quit
+   *   mixes the plays into the WAV file at path,
+   *   at SNDLIB_OFFLINE_FREQUENCY, 16 bit stereo,
+   *   and prints how long the mixing took.
+   * Voices are not limited in either offline
+   * backend. path must stay valid until quit.
+   */
+  void sndlib_set_backend(int backend, const char *path);
+
+
+  /**
+   * The plays recorded so far by an offline
+   * backend. Valid until sndlib_quit.
+   */
+  const sndlib_event *sndlib_get_events(unsigned int *count);
+
+
+  /**
+   * Initialize the sound library and start loading
+   * & decoding all sounds from disk on background
+   * threads. Returns without waiting for them.
+   * Sounds asked for before they are loaded are
+   * skipped, except the wind which starts once it
+   * is ready.
    * Use: call before doing any other sndlib calls.
-   * May take up to 10 seconds to load all sounds.
    */
   void sndlib_init(void);
 
+
+  /**
+   * Wait until all sounds have been loaded.
+   */
+  void sndlib_wait_loaded(void);
+
+
+  /**
+   * Number of sounds loaded so far.
+   */
+  unsigned int sndlib_loaded_count(void);
+
+
+  /**
+   * Number of sounds skipped because they were
+   * not loaded yet or failed to load, or because
+   * every voice played something more important.
+   */
+  unsigned int sndlib_dropped_count(void);
+
+
+  /**
+   * Number of sounds cut off to free a voice for
+   * a sound of the same or higher priority.
+   */
+  unsigned int sndlib_stolen_count(void);
+
   
   /**
    * Finish playing sounds and free up all audio-
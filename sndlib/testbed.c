@@ -22,6 +22,11 @@ int main(void){
   sndlib_init();
   BENCHMARK_TOCK("initialization");
 
+  BENCHMARK_TICK;
+  sndlib_wait_loaded();
+  BENCHMARK_TOCK("loading sounds");
+  printf("%u sounds loaded.\n", sndlib_loaded_count());
+
   BENCHMARK_TICK;
   sndlib_play_wind();
   BENCHMARK_TOCK("playing wind sound");
@@ -0,0 +1,196 @@
+#include <cstdio>
+#include <vector>
+#include <algorithm>
+#include <cstdlib>
+#include "HexmapMesh.h"
+#include "RenderQueue.h"
+#include "SdfFont.h"
+
+/* Checks of the viewer code that runs without a GPU. Prints every failed
+ * check and returns the number of failures.
+ */
+
+static int failures = 0;
+
+#define CHECK(condition) do { if(!(condition)) { \
+    printf("%s:%d: check failed: %s\n", __FILE__, __LINE__, #condition); \
+    failures++; } } while(0)
+
+static void CheckHexmapMesh()
+{
+    // A tile of one triangle and a border of one segment.
+    const float tile[] = {
+        0, 0, 0, 1, 0, 0,
+        1, 0, 0, 1, 1, 0,
+        0, 1, 0, 1, 0, 1
+    };
+    const float border[] = {
+        1, 0, 0, 1,
+        0, 1, 0, 1
+    };
+    HexmapMesh mesh(tile, sizeof(tile) / sizeof(float),
+            border, sizeof(border) / sizeof(float));
+    const uint width = 4;
+    const uint height = 3;
+    std::vector<VectorF2> centers;
+    std::vector<real> rotations;
+    for(uint j = 0; j < height; j++)
+    {
+        for(uint k = 0; k < width; k++)
+        {
+            centers.push_back(VectorF2(k * 2, j * 2));
+            rotations.push_back(0);
+        }
+    }
+    mesh.Bake(centers, rotations);
+
+    const uint tileVertices = 3 + 2;
+    const uint vertices = width * height * tileVertices;
+    const size_t typeOffset = vertices * HexmapMesh::VertexStride;
+    CHECK(mesh.TileCount() == width * height);
+    CHECK(mesh.TileVertexCount() == tileVertices);
+    CHECK(mesh.VertexCount() == vertices);
+    CHECK(mesh.TypeOffset() == typeOffset);
+    CHECK(mesh.Bytes() == typeOffset + vertices * sizeof(float));
+    CHECK(mesh.Min()[0] == 0 && mesh.Min()[1] == 0);
+    CHECK(mesh.Max()[0] == (width - 1) * 2 + 1 && mesh.Max()[1] == (height - 1) * 2 + 1);
+
+    bool full;
+    size_t offset, size;
+    const void *data;
+    CHECK(mesh.TakeUpload(full, offset, size, data));
+    CHECK(full && offset == 0 && size == mesh.Bytes());
+    CHECK(!mesh.TakeUpload(full, offset, size, data));
+
+    // Setting a type a tile already has uploads nothing.
+    mesh.SetType(7, 0);
+    CHECK(!mesh.Dirty());
+
+    // Tiles 2 to 5 are patched in one range, 3 and 4 included.
+    mesh.SetType(5, 3);
+    mesh.SetType(2, 1);
+    mesh.SetType(4, 1);
+    CHECK(mesh.Dirty());
+    CHECK(mesh.TakeUpload(full, offset, size, data));
+    const size_t tileTypeBytes = tileVertices * sizeof(float);
+    CHECK(!full);
+    CHECK(offset == typeOffset + 2 * tileTypeBytes);
+    CHECK(size == 4 * tileTypeBytes);
+    CHECK(((const float*)data)[0] == 1);
+    CHECK(((const float*)data)[3 * tileVertices] == 3);
+    CHECK(!mesh.TakeUpload(full, offset, size, data));
+
+    CHECK(mesh.UploadCount() == 2);
+    CHECK(mesh.UploadedBytes() == mesh.Bytes() + 4 * tileTypeBytes);
+
+    // A new buffer after a destroy gets everything, pending patches included.
+    mesh.SetType(9, 2);
+    mesh.MarkFullUpload();
+    CHECK(mesh.TakeUpload(full, offset, size, data));
+    CHECK(full && offset == 0 && size == mesh.Bytes());
+    CHECK(((const float*)data)[typeOffset / sizeof(float) + 9 * tileVertices] == 2);
+    CHECK(!mesh.TakeUpload(full, offset, size, data));
+}
+
+static void CheckRenderQueue()
+{
+    const uint count = 50;
+    const uint states = 7;
+    RenderQueue queue;
+    queue.Reset(count, states);
+    CHECK(queue.Count() == count);
+    CHECK(queue.StateChanges() == 1);
+
+    std::vector<uint> state(count, 0);
+    std::vector<uint> moved;
+    srand(1);
+    for(uint step = 0; step < 500; step++)
+    {
+        uint id = rand() % count;
+        state[id] = rand() % states;
+        std::vector<uint> before(count);
+        for(uint slot = 0; slot < count; slot++)
+            before[slot] = queue.Id(slot);
+        moved.clear();
+        queue.SetState(id, state[id], moved);
+
+        // One slot per group crossed, plus the one the item lands in.
+        CHECK(moved.size() <= states);
+        std::vector<bool> reported(count, false);
+        for(uint i = 0; i < moved.size(); i++)
+            reported[moved[i]] = true;
+        uint changes = 0;
+        for(uint slot = 0; slot < count; slot++)
+        {
+            uint item = queue.Id(slot);
+            CHECK(queue.Slot(item) == slot);
+            CHECK(reported[slot] == (item != before[slot]));
+            if(slot > 0)
+                CHECK(state[queue.Id(slot - 1)] <= state[item]);
+            if(slot == 0 || state[queue.Id(slot - 1)] != state[item])
+                changes++;
+        }
+        CHECK(queue.StateChanges() == changes);
+    }
+}
+
+static void SetGlyph(textlib_sdf_atlas &atlas, char c, int x, int w, int advance)
+{
+    textlib_sdf_glyph &glyph = atlas.glyphs[c - TEXTLIB_SDF_FIRST];
+    glyph.x = x;
+    glyph.y = 0;
+    glyph.w = w;
+    glyph.h = atlas.line_height;
+    glyph.minx = atlas.spread;
+    glyph.maxy = atlas.ascent - atlas.spread;
+    glyph.advance = advance;
+}
+
+static void CheckSdfLayout()
+{
+    // Cells exactly as high as the line and as wide as the advance, so
+    // the text fills its box.
+    textlib_sdf_atlas atlas = textlib_sdf_atlas();
+    atlas.width = 64;
+    atlas.height = 32;
+    atlas.spread = 2;
+    atlas.ascent = 10;
+    atlas.line_height = 12;
+    SetGlyph(atlas, 'A', 0, 8, 8);
+    SetGlyph(atlas, 'B', 8, 8, 8);
+    // A space is only its border and draws nothing.
+    SetGlyph(atlas, ' ', 16, 2 * atlas.spread, 4);
+
+    std::vector<float> vertices;
+    real aspect = SdfFont::Layout(atlas, "A B\n", vertices);
+    CHECK(aspect == real(8 + 4 + 8) / 12);
+    const uint quadFloats = 6 * SdfFont::VertexSize;
+    CHECK(vertices.size() == 2 * quadFloats);
+    float minX = 1, maxX = -1, minY = 1, maxY = -1;
+    for(uint i = 0; i < vertices.size(); i += SdfFont::VertexSize)
+    {
+        minX = std::min(minX, vertices[i]);
+        maxX = std::max(maxX, vertices[i]);
+        minY = std::min(minY, vertices[i + 1]);
+        maxY = std::max(maxY, vertices[i + 1]);
+        CHECK(vertices[i + 2] >= 0 && vertices[i + 2] <= 16.0f / atlas.width);
+        CHECK(vertices[i + 3] >= 0 && vertices[i + 3] <= 12.0f / atlas.height);
+    }
+    CHECK(minX == -0.5f && maxX == 0.5f);
+    CHECK(minY == -0.5f && maxY == 0.5f);
+    // B starts after A and the space.
+    CHECK(vertices[quadFloats] == 12.0f / 20 - 0.5f);
+
+    CHECK(SdfFont::Layout(atlas, "", vertices) == 0);
+    CHECK(vertices.empty());
+}
+
+int main()
+{
+    CheckHexmapMesh();
+    CheckRenderQueue();
+    CheckSdfLayout();
+    if(failures == 0)
+        printf("All checks passed.\n");
+    return failures;
+}
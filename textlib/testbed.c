@@ -6,8 +6,57 @@
 #define HEIGHT 1000
 
 void print_surface_properties(SDL_Surface *surf, const char *name);
+int check_sdf(void);
+
+#define SDF_SIZE 32
+#define SDF_SPREAD 4
+
+/**
+ * Checks the distance field of a square on the CPU, no fonts needed.
+ * Returns the number of failed checks.
+ */
+int check_sdf(void){
+  unsigned char coverage[SDF_SIZE*SDF_SIZE];
+  unsigned char sdf[SDF_SIZE*SDF_SIZE];
+  int failures = 0;
+  // a 16 texel square in the middle
+  for(int y = 0; y < SDF_SIZE; y++)
+    for(int x = 0; x < SDF_SIZE; x++)
+      coverage[y*SDF_SIZE + x] = (x >= 8 && x < 24 && y >= 8 && y < 24) ? 255 : 0;
+  textlib_sdf_from_coverage(coverage, SDF_SIZE, SDF_SIZE, SDF_SPREAD, sdf);
+
+  // the outline lies between the first texel inside and the last outside
+  int inside = sdf[16*SDF_SIZE + 8];
+  int outside = sdf[16*SDF_SIZE + 7];
+  if(inside <= 128 || outside >= 128 || inside + outside != 256){
+    printf("sdf: edge texels are %d and %d, expected 128 between them\n", inside, outside);
+    failures++;
+  }
+  // beyond the spread the distance saturates at +-127
+  if(sdf[16*SDF_SIZE + 16] != 128 + 127){
+    printf("sdf: center is %d, expected %d\n", sdf[16*SDF_SIZE + 16], 128 + 127);
+    failures++;
+  }
+  if(sdf[0] != 128 - 127){
+    printf("sdf: corner is %d, expected %d\n", sdf[0], 128 - 127);
+    failures++;
+  }
+  // symmetric square, symmetric field
+  int asymmetric = 0;
+  for(int y = 0; y < SDF_SIZE; y++)
+    for(int x = 0; x < SDF_SIZE; x++)
+      asymmetric += sdf[y*SDF_SIZE + x] != sdf[x*SDF_SIZE + y];
+  if(asymmetric != 0){
+    printf("sdf: %d texels differ from their mirror image\n", asymmetric);
+    failures++;
+  }
+  printf("sdf: %s\n", failures == 0 ? "all checks passed" : "checks failed");
+  return failures;
+}
 
 int main(void){
+  if(check_sdf() != 0)
+    exit(EXIT_FAILURE);
   if(SDL_Init(SDL_INIT_VIDEO) < 0){
     printf("Error initializing SDL: %s\n", SDL_GetError());
     exit(EXIT_FAILURE);
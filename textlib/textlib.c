@@ -1,5 +1,7 @@
 #include "textlib.h"
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
 #include <math.h>
 
 // these values are hardcoded for 16-char nametags.
@@ -7,12 +9,172 @@
 #define NAMETAG_WIDTH 256
 #define NAMETAG_HEIGHT 32
 
+#define GLYPH_COUNT 256
+
+// Matches the surfaces TTF_RenderText_Blended returns.
+#define RMASK 0x00ff0000
+#define GMASK 0x0000ff00
+#define BMASK 0x000000ff
+#define AMASK 0xff000000
+
+typedef struct {
+  char *file;
+  int size;
+  TTF_Font *font;
+} textlib_cached_font;
+
+// Rendered glyphs of one font in one quality and color.
+typedef struct {
+  TTF_Font *font;
+  unsigned int quality;
+  SDL_Color color;
+  SDL_Color bgcolor;
+  bool loaded[GLYPH_COUNT];
+  SDL_Surface *surface[GLYPH_COUNT];
+  int minx[GLYPH_COUNT];
+  int maxy[GLYPH_COUNT];
+  int advance[GLYPH_COUNT];
+} textlib_glyph_set;
+
 static TTF_Font *font;
 static unsigned int quality;
 static SDL_Color bgcolor;
 
+static textlib_cached_font *font_cache;
+static unsigned int font_cache_count;
+static textlib_glyph_set **glyph_cache;
+static unsigned int glyph_cache_count;
+
+static bool _textlib_same_color(SDL_Color a, SDL_Color b){
+  return a.r == b.r && a.g == b.g && a.b == b.b;
+}
+
+/**
+ * Returns the font for the given size and file, opening it
+ * only the first time it is asked for. Cached fonts stay open
+ * until textlib_quit().
+ */
+static TTF_Font *_textlib_open_font(int size, const char *the_font){
+  if(the_font == NULL){
+    the_font = DEFAULT_FONT_FILE;
+  }
+  for(unsigned int i = 0; i < font_cache_count; i++){
+    if(font_cache[i].size == size && strcmp(font_cache[i].file, the_font) == 0)
+      return font_cache[i].font;
+  }
+  TTF_Font *opened = TTF_OpenFont(the_font, size);
+  if(opened == NULL){
+    printf("textlib: Error loading font '%s': %s\n", the_font, TTF_GetError());
+    return NULL;
+  }
+  textlib_cached_font *cache = realloc(font_cache, (font_cache_count + 1)*sizeof(textlib_cached_font));
+  char *file = malloc(strlen(the_font) + 1);
+  if(cache == NULL || file == NULL){
+    printf("textlib: out of memory caching font '%s'\n", the_font);
+    exit(EXIT_FAILURE);
+  }
+  strcpy(file, the_font);
+  font_cache = cache;
+  font_cache[font_cache_count].file = file;
+  font_cache[font_cache_count].size = size;
+  font_cache[font_cache_count].font = opened;
+  font_cache_count++;
+  return opened;
+}
+
+/**
+ * Returns the glyph set for rendering with the given font,
+ * quality and color, creating an empty one if needed.
+ */
+static textlib_glyph_set *_textlib_get_glyphs(TTF_Font *the_font, unsigned int the_quality, SDL_Color color){
+  if(the_font == NULL)
+    return NULL;
+  for(unsigned int i = 0; i < glyph_cache_count; i++){
+    textlib_glyph_set *set = glyph_cache[i];
+    if(set->font == the_font && set->quality == the_quality &&
+       _textlib_same_color(set->color, color) &&
+       (the_quality != TEXT_QUALITY_MEDIUM || _textlib_same_color(set->bgcolor, bgcolor)))
+      return set;
+  }
+  textlib_glyph_set **cache = realloc(glyph_cache, (glyph_cache_count + 1)*sizeof(textlib_glyph_set*));
+  textlib_glyph_set *set = calloc(1, sizeof(textlib_glyph_set));
+  if(cache == NULL || set == NULL){
+    printf("textlib: out of memory caching glyphs\n");
+    exit(EXIT_FAILURE);
+  }
+  set->font = the_font;
+  set->quality = the_quality;
+  set->color = color;
+  set->bgcolor = bgcolor;
+  glyph_cache = cache;
+  glyph_cache[glyph_cache_count++] = set;
+  return set;
+}
+
+static void _textlib_load_glyph(textlib_glyph_set *set, unsigned char c){
+  int minx = 0, maxx = 0, miny = 0, maxy = 0, advance = 0;
+  set->loaded[c] = true;
+  if(TTF_GlyphMetrics(set->font, c, &minx, &maxx, &miny, &maxy, &advance) == -1)
+    return;
+  set->minx[c] = minx;
+  set->maxy[c] = maxy;
+  set->advance[c] = advance;
+  if(maxx <= minx)
+    return; // nothing to draw, e.g. a space
+  switch (set->quality){
+  case 2:
+    set->surface[c] = TTF_RenderGlyph_Blended(set->font, c, set->color);
+    break;
+  case 1:
+    set->surface[c] = TTF_RenderGlyph_Shaded(set->font, c, set->color, set->bgcolor);
+    break;
+  default:
+    set->surface[c] = TTF_RenderGlyph_Solid(set->font, c, set->color);
+    break;
+  }
+}
+
+static int _textlib_text_width(textlib_glyph_set *set, const char *text){
+  int width = 0;
+  for(const unsigned char *c = (const unsigned char*)text; *c != '\0'; c++){
+    if(!set->loaded[*c])
+      _textlib_load_glyph(set, *c);
+    width += set->advance[*c];
+  }
+  return width;
+}
+
+/**
+ * Blits text from cached glyphs onto dest, with the top of
+ * the line at (x, y). Kerning is not applied. With copy_alpha
+ * the glyph pixels replace those of dest, alpha included,
+ * instead of being blended onto them.
+ */
+static void _textlib_draw_text(textlib_glyph_set *set, const char *text, SDL_Surface *dest, int x, int y, bool copy_alpha){
+  int ascent = TTF_FontAscent(set->font);
+  for(const unsigned char *c = (const unsigned char*)text; *c != '\0'; c++){
+    if(!set->loaded[*c])
+      _textlib_load_glyph(set, *c);
+    SDL_Surface *glyph = set->surface[*c];
+    if(glyph != NULL){
+      SDL_Rect placement = {x + set->minx[*c], y + ascent - set->maxy[*c], glyph->w, glyph->h};
+      Uint32 flags = glyph->flags & SDL_SRCALPHA;
+      if(copy_alpha)
+        SDL_SetAlpha(glyph, 0, 255);
+      SDL_BlitSurface(glyph, NULL, dest, &placement);
+      if(copy_alpha)
+        SDL_SetAlpha(glyph, flags, 255);
+    }
+    x += set->advance[*c];
+  }
+}
+
 void textlib_initialize(void){
   font = NULL;
+  font_cache = NULL;
+  font_cache_count = 0;
+  glyph_cache = NULL;
+  glyph_cache_count = 0;
   if(TTF_Init() == -1){
     printf("textlib: error initializing SDL_ttf: %s\n", TTF_GetError());
     exit(EXIT_FAILURE);
@@ -34,24 +196,28 @@ void textlib_set_quality(unsigned int the_quality){
 }
 
 void textlib_set_font(int dpi, const char *the_font){
-  if(font != NULL)
-      TTF_CloseFont(font);
-
-  if(the_font == NULL){
-    the_font = (char*)DEFAULT_FONT_FILE;
-  }
-  font = TTF_OpenFont(the_font, dpi);
-  if(font == NULL){
-    printf("textlib: Error loading font '%s': %s\n", the_font, TTF_GetError());
-  }
+  font = _textlib_open_font(dpi, the_font);
 }
 
 void textlib_quit(void){
-  if(font != NULL)
-  {
-    TTF_CloseFont(font);
-    font = NULL;
+  for(unsigned int i = 0; i < glyph_cache_count; i++){
+    for(int c = 0; c < GLYPH_COUNT; c++){
+      if(glyph_cache[i]->surface[c] != NULL)
+        SDL_FreeSurface(glyph_cache[i]->surface[c]);
+    }
+    free(glyph_cache[i]);
+  }
+  free(glyph_cache);
+  glyph_cache = NULL;
+  glyph_cache_count = 0;
+  for(unsigned int i = 0; i < font_cache_count; i++){
+    TTF_CloseFont(font_cache[i].font);
+    free(font_cache[i].file);
   }
+  free(font_cache);
+  font_cache = NULL;
+  font_cache_count = 0;
+  font = NULL;
   TTF_Quit();
 }
 
@@ -73,19 +239,12 @@ SDL_Surface *textlib_get_text(const char *text, Uint8 r, Uint8 g, Uint8 b){
 }
 
 SDL_Surface *textlib_get_nametag(const char *name, float health){
-  TTF_Font *oldfont = font;
-  unsigned int oldquality = quality;
-  
-  font = NULL;
-  textlib_set_font(24, NULL);
-  textlib_set_quality(TEXT_QUALITY_HIGH);
-  SDL_Surface *nametag = textlib_get_text(name, 0, 0, 0);
+  SDL_Color black = {0, 0, 0, 255};
+  textlib_glyph_set *glyphs = _textlib_get_glyphs(_textlib_open_font(24, NULL),
+						  TEXT_QUALITY_HIGH, black);
   SDL_Surface *bg = SDL_CreateRGBSurface(SDL_SWSURFACE,
-					 //nametag->w+10, nametag->h+10,
-					 NAMETAG_WIDTH, NAMETAG_HEIGHT,
-					 nametag->format->BitsPerPixel,
-					 nametag->format->Rmask, nametag->format->Gmask,
-					 nametag->format->Bmask, nametag->format->Amask);
+					 NAMETAG_WIDTH, NAMETAG_HEIGHT, 32,
+					 RMASK, GMASK, BMASK, AMASK);
   unsigned int pixel_fill_boundary = (unsigned int)round(health*(NAMETAG_WIDTH-4));
   SDL_FillRect(bg, NULL, SDL_MapRGBA(bg->format, 0, 0, 0, 255));
   
@@ -95,16 +254,29 @@ SDL_Surface *textlib_get_nametag(const char *name, float health){
   SDL_Rect health_rect = {2, 2, pixel_fill_boundary, NAMETAG_HEIGHT - 4};
   SDL_FillRect(bg, &health_rect, SDL_MapRGBA(bg->format, 100, 255, 100, 255));
 
-  SDL_Rect name_rect = {(int)round(NAMETAG_WIDTH/2.0 - (nametag->w)/2), 3, nametag->w, nametag->h};
-  SDL_BlitSurface(nametag, NULL, bg, &name_rect);
-  
-  TTF_CloseFont(font);
-  font = oldfont;
-  quality = oldquality;
-  SDL_FreeSurface(nametag);
+  if(glyphs != NULL){
+    int name_width = _textlib_text_width(glyphs, name);
+    _textlib_draw_text(glyphs, name, bg, (int)round(NAMETAG_WIDTH/2.0 - name_width/2), 3, false);
+  }
   return bg;
 }
 
+SDL_Surface *textlib_get_nametag_name(const char *name){
+  SDL_Color black = {0, 0, 0, 255};
+  textlib_glyph_set *glyphs = _textlib_get_glyphs(_textlib_open_font(24, NULL),
+						  TEXT_QUALITY_HIGH, black);
+  SDL_Surface *tag = SDL_CreateRGBSurface(SDL_SWSURFACE,
+					  NAMETAG_WIDTH, NAMETAG_HEIGHT, 32,
+					  RMASK, GMASK, BMASK, AMASK);
+  SDL_FillRect(tag, NULL, SDL_MapRGBA(tag->format, 0, 0, 0, 0));
+  if(glyphs != NULL){
+    // copy the alpha channel instead of blending onto the transparent tag
+    int name_width = _textlib_text_width(glyphs, name);
+    _textlib_draw_text(glyphs, name, tag, (int)round(NAMETAG_WIDTH/2.0 - name_width/2), 3, true);
+  }
+  return tag;
+}
+
 SDL_Surface *_textlib_get_playerstats(const char *, int, const char *, int, const char *, int, bool);
 SDL_Surface *_textlib_get_playerstats(const char *name, int points, const char *primary, 
 				      int primary_lvl, const char *secondary, int secondary_lvl, bool last){
@@ -116,18 +288,8 @@ SDL_Surface *_textlib_get_playerstats(const char *name, int points, const char *
   return textlib_get_text(string, 255, 255, 255);
 }
 
-SDL_Surface *textlib_get_stats(unsigned int players, const char **names,
-			       int *points, const char **primary_weapon, const char **secondary_weapon, int screen_width){
-  if(players == 0){
-    return NULL;
-  }
-  unsigned int extra_padding;
-  bool two_lines;
+int textlib_get_stats_font_size(unsigned int players){
   int font_size = 14;
-  int height = 64;
-
-  extra_padding = (unsigned int)(48 - players*2.5);
-
   if(players <= 4)
     font_size = 28;
   if(players > 4 && players <= 8)
@@ -136,19 +298,34 @@ SDL_Surface *textlib_get_stats(unsigned int players, const char **names,
     font_size = 19;
   if(players > 12 && players <= 14)
     font_size = 16;
+  return font_size;
+}
 
+SDL_Surface *textlib_get_stats_segment(const char *name, int points, bool last, int font_size){
   TTF_Font *oldfont = font;
   unsigned int oldquality = quality;
-  font = NULL;
-  textlib_set_font(font_size, NULL);
-  textlib_set_quality(TEXT_QUALITY_HIGH);
+  font = _textlib_open_font(font_size, NULL);
+  quality = TEXT_QUALITY_HIGH;
+  SDL_Surface *segment = NULL;
+  if(font != NULL)
+    segment = _textlib_get_playerstats(name, points, NULL, 1, NULL, 1, last);
+  // restore old font settings
+  font = oldfont;
+  quality = oldquality;
+  return segment;
+}
+
+SDL_Surface *textlib_compose_stats(unsigned int players, SDL_Surface **surfaces, int screen_width){
+  if(players == 0){
+    return NULL;
+  }
+  unsigned int extra_padding;
+  int height = 64;
+
+  extra_padding = (unsigned int)(48 - players*2.5);
 
-  SDL_Surface *surfaces[players];
-  int total_width = 0;
   int extra_width = 0;
   for(int i = 0; i < players; i++){
-    surfaces[i] = _textlib_get_playerstats(names[i], points[i], primary_weapon[i], 1, secondary_weapon[i], 1, i == players-1);
-    total_width += surfaces[i]->w;
     extra_width += surfaces[i]->w + extra_padding;
   }
   SDL_Surface *bg = SDL_CreateRGBSurface(SDL_SWSURFACE,
@@ -172,7 +349,6 @@ SDL_Surface *textlib_get_stats(unsigned int players, const char **names,
     for(int i = 0; i < top_row_players; i++){
       SDL_Rect placement = {x_position, first_row_y_displacement, surfaces[i]->w, surfaces[i]->h};
       SDL_BlitSurface(surfaces[i], NULL, bg, &placement);
-      SDL_FreeSurface(surfaces[i]);
       x_position += surfaces[i]->w + extra_padding;
     }
     
@@ -181,11 +357,9 @@ SDL_Surface *textlib_get_stats(unsigned int players, const char **names,
       second_row_width += surfaces[i]->w + extra_padding;
     
     x_position = (int)((screen_width - second_row_width)/2.0);
-    printf("x_position for second row: %d\n", x_position);
     for(int i = top_row_players; i < players; i++){
       SDL_Rect placement = {x_position, second_row_y_displacement, surfaces[i]->w, surfaces[i]->h};
       SDL_BlitSurface(surfaces[i], NULL, bg, &placement);
-      SDL_FreeSurface(surfaces[i]);
       x_position += surfaces[i]->w + extra_padding;
     }
   }
@@ -200,18 +374,150 @@ SDL_Surface *textlib_get_stats(unsigned int players, const char **names,
       SDL_Rect placement = {x_position, y_displacement, surfaces[i]->w, surfaces[i]->h};
       SDL_BlitSurface(surfaces[i], NULL, bg, &placement);
       x_position += surfaces[i]->w + extra_padding;
-      SDL_FreeSurface(surfaces[i]);
     }
   }
+  return bg;
+}
 
-  TTF_CloseFont(font);
-  // restore old font settings
-  font = oldfont;
-  quality = oldquality;
+SDL_Surface *textlib_get_stats(unsigned int players, const char **names,
+			       int *points, const char **primary_weapon, const char **secondary_weapon, int screen_width){
+  if(players == 0){
+    return NULL;
+  }
+  int font_size = textlib_get_stats_font_size(players);
+  SDL_Surface **surfaces = malloc(players*sizeof(SDL_Surface*));
+  if(surfaces == NULL){
+    printf("textlib: out of memory rendering stats\n");
+    return NULL;
+  }
+  for(int i = 0; i < players; i++){
+    surfaces[i] = textlib_get_stats_segment(names[i], points[i], i == players-1, font_size);
+  }
+  SDL_Surface *bg = textlib_compose_stats(players, surfaces, screen_width);
+  for(int i = 0; i < players; i++){
+    SDL_FreeSurface(surfaces[i]);
+  }
+  free(surfaces);
   return bg;
 }
 
 
+void textlib_sdf_from_coverage(const unsigned char *coverage, int w, int h, int spread, unsigned char *sdf){
+  for(int y = 0; y < h; y++){
+    for(int x = 0; x < w; x++){
+      bool inside = coverage[y*w + x] >= 128;
+      int best = spread*spread + 1;
+      for(int dy = -spread; dy <= spread; dy++){
+	int sy = y + dy;
+	for(int dx = -spread; dx <= spread; dx++){
+	  int sx = x + dx;
+	  // everything off the buffer is outside
+	  bool other = sx >= 0 && sx < w && sy >= 0 && sy < h && coverage[sy*w + sx] >= 128;
+	  if(other != inside && dx*dx + dy*dy < best)
+	    best = dx*dx + dy*dy;
+	}
+      }
+      // the outline lies half way between an inside and an outside texel
+      float distance = best > spread*spread ? (float)spread : sqrtf((float)best) - 0.5f;
+      float value = 128.0f + (inside ? distance : -distance)*127.0f/(float)spread;
+      if(value < 0.0f)
+	value = 0.0f;
+      if(value > 255.0f)
+	value = 255.0f;
+      sdf[y*w + x] = (unsigned char)(value + 0.5f);
+    }
+  }
+}
+
+#define SDF_ATLAS_WIDTH 512
+
+textlib_sdf_atlas *textlib_get_sdf_atlas(int size, const char *the_font, int spread){
+  TTF_Font *sdf_font = _textlib_open_font(size, the_font);
+  if(sdf_font == NULL)
+    return NULL;
+  textlib_sdf_atlas *atlas = calloc(1, sizeof(textlib_sdf_atlas));
+  if(atlas == NULL){
+    printf("textlib: out of memory building distance field atlas\n");
+    return NULL;
+  }
+  atlas->size = size;
+  atlas->spread = spread;
+  atlas->ascent = TTF_FontAscent(sdf_font);
+  atlas->line_height = TTF_FontHeight(sdf_font);
+
+  // render every glyph and pack the cells on shelves
+  SDL_Color white = {255, 255, 255, 255};
+  SDL_Surface *surfaces[TEXTLIB_SDF_COUNT];
+  int x = 0, y = 0, shelf = 0;
+  for(int i = 0; i < TEXTLIB_SDF_COUNT; i++){
+    textlib_sdf_glyph *glyph = &atlas->glyphs[i];
+    int minx = 0, maxx = 0, miny = 0, maxy = 0, advance = 0;
+    surfaces[i] = NULL;
+    if(TTF_GlyphMetrics(sdf_font, (Uint16)(TEXTLIB_SDF_FIRST + i), &minx, &maxx, &miny, &maxy, &advance) == 0){
+      glyph->minx = minx;
+      glyph->maxy = maxy;
+      glyph->advance = advance;
+      if(maxx > minx)
+	surfaces[i] = TTF_RenderGlyph_Blended(sdf_font, (Uint16)(TEXTLIB_SDF_FIRST + i), white);
+    }
+    glyph->w = (surfaces[i] != NULL ? surfaces[i]->w : 0) + 2*spread;
+    glyph->h = (surfaces[i] != NULL ? surfaces[i]->h : 0) + 2*spread;
+    if(x + glyph->w > SDF_ATLAS_WIDTH){
+      x = 0;
+      y += shelf;
+      shelf = 0;
+    }
+    glyph->x = x;
+    glyph->y = y;
+    x += glyph->w;
+    if(glyph->h > shelf)
+      shelf = glyph->h;
+  }
+  atlas->width = SDF_ATLAS_WIDTH;
+  atlas->height = 1;
+  while(atlas->height < y + shelf)
+    atlas->height *= 2;
+  atlas->pixels = calloc((size_t)(atlas->width*atlas->height), 1);
+
+  for(int i = 0; i < TEXTLIB_SDF_COUNT; i++){
+    if(surfaces[i] == NULL)
+      continue;
+    textlib_sdf_glyph *glyph = &atlas->glyphs[i];
+    unsigned char *coverage = calloc((size_t)(glyph->w*glyph->h), 1);
+    unsigned char *sdf = malloc((size_t)(glyph->w*glyph->h));
+    if(atlas->pixels != NULL && coverage != NULL && sdf != NULL){
+      SDL_Surface *surface = surfaces[i];
+      SDL_PixelFormat *format = surface->format;
+      SDL_LockSurface(surface);
+      for(int sy = 0; sy < surface->h; sy++){
+	Uint32 *row = (Uint32*)((Uint8*)surface->pixels + sy*surface->pitch);
+	for(int sx = 0; sx < surface->w; sx++)
+	  coverage[(sy + spread)*glyph->w + sx + spread] = (unsigned char)((row[sx] & format->Amask) >> format->Ashift);
+      }
+      SDL_UnlockSurface(surface);
+      textlib_sdf_from_coverage(coverage, glyph->w, glyph->h, spread, sdf);
+      for(int cy = 0; cy < glyph->h; cy++)
+	memcpy(atlas->pixels + (glyph->y + cy)*atlas->width + glyph->x, sdf + cy*glyph->w, (size_t)glyph->w);
+    }
+    free(coverage);
+    free(sdf);
+    SDL_FreeSurface(surfaces[i]);
+  }
+  if(atlas->pixels == NULL){
+    printf("textlib: out of memory building distance field atlas\n");
+    free(atlas);
+    return NULL;
+  }
+  return atlas;
+}
+
+void textlib_free_sdf_atlas(textlib_sdf_atlas *atlas){
+  if(atlas == NULL)
+    return;
+  free(atlas->pixels);
+  free(atlas);
+}
+
 SDL_Surface *textlib_get_finalscreen(unsigned int players, const char **names, int *points, 
 				     char **primary_weapons, int *primary_weapon_lvls, 
 				     char **secondary_weapons, int *secondary_weapon_lvls, 
@@ -35,6 +35,38 @@ extern "C" {
  */
 #define TEXT_QUALITY_HIGH 2
 
+/**
+ * First character and number of characters
+ * in a signed distance field atlas.
+ */
+#define TEXTLIB_SDF_FIRST 32
+#define TEXTLIB_SDF_COUNT 95
+
+/**
+ * A glyph in a signed distance field atlas.
+ * x, y, w and h are its cell in the atlas,
+ * which includes a border of spread texels.
+ * minx, maxy and advance are the glyph's
+ * metrics as given by TTF_GlyphMetrics().
+ */
+typedef struct {
+  int x, y, w, h;
+  int minx, maxy, advance;
+} textlib_sdf_glyph;
+
+/**
+ * Signed distance field glyphs of one font,
+ * one byte per texel. 128 lies on the outline,
+ * and each texel away from it adds or takes
+ * 127/spread, up to 255 inside and 1 outside.
+ */
+typedef struct {
+  int width, height;
+  unsigned char *pixels;
+  int size, spread, ascent, line_height;
+  textlib_sdf_glyph glyphs[TEXTLIB_SDF_COUNT];
+} textlib_sdf_atlas;
+
 /**
  * Initializes the library. Needs to be called before doing
  * any other text-related operations.
@@ -52,7 +84,8 @@ void textlib_quit(void);
  * is in points relative to 72dpi. The font-file
  * can be any .ttf file or NULL, in which case
  * a default font file specified in DEFAULT_FONT_FILE
- * is used instead.
+ * is used instead. Fonts are opened once and kept
+ * until textlib_quit().
  */
 void textlib_set_font(int, const char*);
 
@@ -84,9 +117,18 @@ SDL_Surface *textlib_get_text(const char *, Uint8, Uint8, Uint8);
  * a SDL_Surface. The name should not
  * contain more than 16 letters, and
  * health is a float 0 <= health <= 1.
+ * The name is drawn from cached glyphs.
  */
 SDL_Surface *textlib_get_nametag(const char *name, float health);
 
+/**
+ * Renders only the name of a nametag,
+ * placed as in textlib_get_nametag() on
+ * a transparent surface, for drawing the
+ * health-bar separately.
+ */
+SDL_Surface *textlib_get_nametag_name(const char *name);
+
 /**
  * Renders a table of statistics about
  * each player to an opaque surface.
@@ -96,6 +138,49 @@ SDL_Surface *textlib_get_nametag(const char *name, float health);
 SDL_Surface *textlib_get_stats(unsigned int players, const char **names,
 			       int *points, const char **primary_weapon, const char **secondary_weapon, int screen_width);
 
+/**
+ * Returns the font-size textlib_get_stats()
+ * uses for the given number of players.
+ */
+int textlib_get_stats_font_size(unsigned int players);
+
+/**
+ * Renders one player's part of the
+ * statistics table. last is set for
+ * the final player in the table.
+ */
+SDL_Surface *textlib_get_stats_segment(const char *name, int points, bool last, int font_size);
+
+/**
+ * Lays out pre-rendered segments from
+ * textlib_get_stats_segment() into a
+ * statistics table. The segments are
+ * not freed.
+ */
+SDL_Surface *textlib_compose_stats(unsigned int players, SDL_Surface **segments, int screen_width);
+
+/**
+ * Computes a signed distance field from
+ * w x h coverage values, where a value of at
+ * least 128 is inside. Distances are searched
+ * up to spread texels away. Needs no fonts.
+ */
+void textlib_sdf_from_coverage(const unsigned char *coverage, int w, int h, int spread, unsigned char *sdf);
+
+/**
+ * Renders the printable ASCII glyphs of a
+ * font at the given size into a signed
+ * distance field atlas. The font-file is
+ * handled as in textlib_set_font(). Returns
+ * NULL if the font could not be loaded.
+ */
+textlib_sdf_atlas *textlib_get_sdf_atlas(int size, const char *the_font, int spread);
+
+/**
+ * Frees an atlas from textlib_get_sdf_atlas().
+ */
+void textlib_free_sdf_atlas(textlib_sdf_atlas *atlas);
+
 /**
  * Renders a fullscreen scoreboard.
  *